@@ -0,0 +1,631 @@
+// -----------------------------
+// projects/graph/BenchGraph.c++
+// -----------------------------
+
+/*
+To compile the benchmark:
+    % g++ -O2 -DNDEBUG -pedantic -std=c++11 -Wall BenchGraph.c++ -o BenchGraph -lpthread
+
+To run the benchmark:
+    % BenchGraph > bench_output.txt
+    % BenchGraph quick > bench_output.txt
+
+Every result is one JSON object per line, e.g.
+    {"bench": "edge", "graph": "Graph", "shape": "uniform", "vertices": 1000, "edges": 9950, "ns_per_op": 41.2, ...}
+so runs can be diffed or loaded into a table to track regressions.
+*/
+
+// --------
+// includes
+// --------
+
+#include <chrono>     // steady_clock
+#include <cstddef>    // size_t
+#include <cstdio>     // remove
+#include <cstring>    // strcmp
+#include <functional> // cref
+#include <iostream>   // cout, endl
+#include <iterator>   // back_inserter
+#include <limits>     // numeric_limits
+#include <sstream>    // ostringstream
+#include <string>     // string
+#include <thread>     // thread
+#include <type_traits> // enable_if, is_integral
+#include <utility>    // make_pair, pair, swap
+#include <vector>     // vector
+
+#include <fcntl.h>    // open, posix_fadvise
+#include <sys/mman.h> // mincore, mmap, munmap
+#include <sys/stat.h> // fstat
+#include <unistd.h>   // close, fdatasync, sysconf
+
+#include "boost/graph/adjacency_list.hpp" // adjacency_list
+
+#include "CountingNew.h" // allocated_blocks, allocated_bytes, live_bytes
+#include "Graph.h"
+
+// ------
+// Record
+// ------
+
+/**
+ * One line of output: a JSON object written when the Record is destroyed.
+ */
+class Record {
+    private:
+        // ----
+        // data
+        // ----
+
+        std::ostringstream _s;
+
+        // ---
+        // key
+        // ---
+
+        void key (const char* k) {
+            if (!_s.str().empty())
+                _s << ", ";
+            _s << '"' << k << "\": ";}
+
+    public:
+        // -----------
+        // constructor
+        // -----------
+
+        /**
+         * @param bench : name of the benchmark
+         */
+        explicit Record (const char* bench) {
+            _s.precision(std::numeric_limits<double>::max_digits10);
+            add("bench", bench);}
+
+        Record (const Record&) = delete;
+        Record& operator = (const Record&) = delete;
+
+        // ----------
+        // destructor
+        // ----------
+
+        ~Record () {
+            std::cout << "{" << _s.str() << "}" << std::endl;}
+
+        // ---
+        // add
+        // ---
+
+        Record& add (const char* k, const char* v) {
+            key(k);
+            _s << '"' << v << '"';
+            return *this;}
+
+        Record& add (const char* k, bool v) {
+            key(k);
+            _s << (v ? "true" : "false");
+            return *this;}
+
+        /**
+         * doubles are written with enough digits to read back exactly
+         */
+        Record& add (const char* k, double v) {
+            key(k);
+            _s << v;
+            return *this;}
+
+        /**
+         * counts are written as integers, never through double
+         */
+        template <typename T>
+        typename std::enable_if<std::is_integral<T>::value, Record&>::type add (const char* k, T v) {
+            key(k);
+            _s << v;
+            return *this;}};
+
+// -------
+// elapsed
+// -------
+
+/**
+ * @param b : start time
+ * @return : nanoseconds since b
+ */
+double elapsed (std::chrono::steady_clock::time_point b) {
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - b).count();}
+
+// ------------
+// random_edges
+// ------------
+
+/**
+ * @param n : number of vertices
+ * @param m : number of edges, duplicates included
+ * @return : m edges with uniformly distributed endpoints, from a fixed seed
+ */
+std::vector<Graph::edge_descriptor> random_edges (Graph::vertices_size_type n, Graph::edges_size_type m) {
+    std::vector<Graph::edge_descriptor> x;
+    x.reserve(m);
+    unsigned long long r = 88172645463325252ULL;
+    for (Graph::edges_size_type i = 0; i != m; ++i) {
+        r ^= r << 13;
+        r ^= r >> 7;
+        r ^= r << 17;
+        x.push_back(std::make_pair(static_cast<Graph::vertex_descriptor>(r % n), static_cast<Graph::vertex_descriptor>((r >> 32) % n)));}
+    return x;}
+
+// ----------
+// rmat_edges
+// ----------
+
+/**
+ * @param n : number of vertices
+ * @param m : number of edges, duplicates included
+ * @return : m edges from the R-MAT recursive generator (a = 0.57, b = c = 0.19),
+ * whose degrees follow a power law, from a fixed seed
+ */
+std::vector<Graph::edge_descriptor> rmat_edges (Graph::vertices_size_type n, Graph::edges_size_type m) {
+    unsigned k = 0;
+    while ((Graph::vertices_size_type(1) << k) < n)
+        ++k;
+    std::vector<Graph::edge_descriptor> x;
+    x.reserve(m);
+    unsigned long long r = 2463534242ULL;
+    for (Graph::edges_size_type i = 0; i != m; ++i) {
+        Graph::vertices_size_type s = 0;
+        Graph::vertices_size_type t = 0;
+        for (unsigned j = 0; j != k; ++j) {
+            r ^= r << 13;
+            r ^= r >> 7;
+            r ^= r << 17;
+            const unsigned q = r % 100;
+            s = (s << 1) | (q >= 76 ? 1 : 0);
+            t = (t << 1) | (((q >= 57) && (q < 76)) || (q >= 95) ? 1 : 0);}
+        x.push_back(std::make_pair(static_cast<Graph::vertex_descriptor>(s % n), static_cast<Graph::vertex_descriptor>(t % n)));}
+    return x;}
+
+// -----------
+// chain_edges
+// -----------
+
+/**
+ * @param n : number of vertices
+ * @return : the n - 1 edges of the path 0, 1, ..., n - 1
+ */
+std::vector<Graph::edge_descriptor> chain_edges (Graph::vertices_size_type n) {
+    std::vector<Graph::edge_descriptor> x;
+    for (Graph::vertex_descriptor v = 0; v + 1 < n; ++v)
+        x.push_back(std::make_pair(v, v + 1));
+    return x;}
+
+// -------
+// Measure
+// -------
+
+/**
+ * Runs f until at least 50 ms have passed and records the mean time per
+ * op; allocations are counted over the first run only, and include blocks
+ * that were freed again, so they track allocation traffic, not footprint.
+ */
+struct Measure {
+    double ns_per_op;
+    double allocs_per_op;
+    double alloc_bytes;
+
+    /**
+     * @param f : callable, one run
+     * @param ops : operations in one run
+     */
+    template <typename F>
+    Measure (F f, std::size_t ops) {
+        const std::size_t blocks = allocated_blocks;
+        const std::size_t before = allocated_bytes;
+        std::chrono::steady_clock::time_point b = std::chrono::steady_clock::now();
+        f();
+        allocs_per_op = double(allocated_blocks - blocks) / ops;
+        alloc_bytes   = double(allocated_bytes - before);
+        std::size_t runs = 1;
+        while (elapsed(b) < 5e7) {
+            f();
+            ++runs;}
+        ns_per_op = elapsed(b) / runs / ops;}};
+
+// ----
+// sink
+// ----
+
+// results of the timed loops land here, so they are not optimized away
+static volatile unsigned long long sink;
+
+// ----------------
+// bench_operations
+// ----------------
+
+/**
+ * times the free-function interface of G on one edge list
+ * @param graph : name of G
+ * @param shape : name of the edge list's generator
+ * @param n : number of vertices
+ * @param x : edges
+ */
+template <typename G>
+void bench_operations (const char* graph, const char* shape, typename G::vertices_size_type n, const std::vector<Graph::edge_descriptor>& x) {
+    typedef typename G::vertex_descriptor  vertex_descriptor;
+    typedef typename G::edge_iterator      edge_iterator;
+    typedef typename G::adjacency_iterator adjacency_iterator;
+
+    // bytes_per_* are live bytes, what the graph holds once built
+    std::size_t live = live_bytes();
+    G g;
+    for (std::size_t i = 0; i != x.size(); ++i)
+        add_edge(x[i].first, x[i].second, g);
+    while (num_vertices(g) < n)
+        add_vertex(g);
+    const double edge_bytes = double(live_bytes() - live);
+    const std::size_t m = num_edges(g);
+
+    live = live_bytes();
+    double vertex_bytes;
+    {
+    G h;
+    for (std::size_t i = 0; i != n; ++i)
+        add_vertex(h);
+    vertex_bytes = double(live_bytes() - live);
+    }
+
+    live = live_bytes();
+    double copy_bytes;
+    {
+    G h(g);
+    copy_bytes = double(live_bytes() - live);
+    }
+
+    // each run builds and destroys a graph
+    Measure a([&] () {
+        G h;
+        for (std::size_t i = 0; i != x.size(); ++i)
+            add_edge(x[i].first, x[i].second, h);}, x.size());
+    Record("add_edge").add("graph", graph).add("shape", shape).add("vertices", n).add("edges", m)
+        .add("ns_per_op", a.ns_per_op).add("allocs_per_op", a.allocs_per_op)
+        .add("bytes_per_edge", edge_bytes / m).add("alloc_bytes_per_edge", a.alloc_bytes / m);
+
+    Measure v([&] () {
+        G h;
+        for (std::size_t i = 0; i != n; ++i)
+            add_vertex(h);}, n);
+    Record("add_vertex").add("graph", graph).add("shape", shape).add("vertices", n).add("edges", m)
+        .add("ns_per_op", v.ns_per_op).add("allocs_per_op", v.allocs_per_op)
+        .add("bytes_per_vertex", vertex_bytes / n).add("alloc_bytes_per_vertex", v.alloc_bytes / n);
+
+    // half the queries hit, half are random pairs that mostly miss
+    std::vector< std::pair<vertex_descriptor, vertex_descriptor> > q;
+    for (std::size_t i = 0; i < x.size(); i += 2) {
+        q.push_back(std::make_pair(x[i].first, x[i].second));
+        q.push_back(std::make_pair(x[i].second, (x[i].first * 7 + i) % n));}
+    Measure e([&] () {
+        unsigned long long r = 0;
+        for (std::size_t i = 0; i != q.size(); ++i)
+            r += edge(q[i].first, q[i].second, g).second;
+        sink = r;}, q.size());
+    Record("edge").add("graph", graph).add("shape", shape).add("vertices", n).add("edges", m)
+        .add("ns_per_op", e.ns_per_op).add("allocs_per_op", e.allocs_per_op);
+
+    Measure i([&] () {
+        unsigned long long r = 0;
+        edge_iterator b = edges(g).first;
+        edge_iterator e = edges(g).second;
+        for (; b != e; ++b)
+            r += target(*b, g);
+        sink = r;}, m);
+    Record("edges").add("graph", graph).add("shape", shape).add("vertices", n).add("edges", m)
+        .add("ns_per_op", i.ns_per_op).add("allocs_per_op", i.allocs_per_op);
+
+    Measure s([&] () {
+        unsigned long long r = 0;
+        for (std::size_t u = 0; u != n; ++u) {
+            adjacency_iterator b = adjacent_vertices(u, g).first;
+            adjacency_iterator e = adjacent_vertices(u, g).second;
+            for (; b != e; ++b)
+                r += *b;}
+        sink = r;}, m);
+    Record("adjacent_vertices").add("graph", graph).add("shape", shape).add("vertices", n).add("edges", m)
+        .add("ns_per_op", s.ns_per_op).add("allocs_per_op", s.allocs_per_op);
+
+    Measure c([&] () {
+        G h(g);
+        sink = num_edges(h);}, m);
+    Record("copy").add("graph", graph).add("shape", shape).add("vertices", n).add("edges", m)
+        .add("ns_per_op", c.ns_per_op).add("allocs_per_op", c.allocs_per_op)
+        .add("bytes_per_edge", copy_bytes / m).add("alloc_bytes_per_edge", c.alloc_bytes / m);}
+
+// ----------------
+// bench_both_types
+// ----------------
+
+/**
+ * bench_operations on the same types as the TestGraph fixture
+ * @param shape : name of the edge list's generator
+ * @param n : number of vertices
+ * @param x : edges
+ */
+void bench_both_types (const char* shape, Graph::vertices_size_type n, const std::vector<Graph::edge_descriptor>& x) {
+    bench_operations< boost::adjacency_list<boost::setS, boost::vecS, boost::directedS> >("boost::adjacency_list", shape, n, x);
+    bench_operations<Graph>("Graph", shape, n, x);}
+
+// -----------
+// bench_build
+// -----------
+
+/**
+ * compares building with add_edge, one edge at a time, against from_edges
+ * @param n : number of vertices
+ * @param m : number of edges
+ */
+void bench_build (Graph::vertices_size_type n, Graph::edges_size_type m) {
+    const std::vector<Graph::edge_descriptor> x = random_edges(n, m);
+
+    std::chrono::steady_clock::time_point b = std::chrono::steady_clock::now();
+    {
+    Graph g;
+    for (Graph::edges_size_type i = 0; i != x.size(); ++i)
+        add_edge(x[i].first, x[i].second, g);
+    }
+    const double a = elapsed(b);
+
+    b = std::chrono::steady_clock::now();
+    {
+    Graph g = Graph::from_edges(x.begin(), x.end(), n);
+    }
+    const double f = elapsed(b);
+
+    Record("build").add("vertices", n).add("edges", m)
+        .add("add_edge_ns_per_edge", a / m).add("from_edges_ns_per_edge", f / m);}
+
+// ---------
+// build_one
+// ---------
+
+/**
+ * builds a graph with add_edge and destroys it
+ * @param x : edges
+ */
+void build_one (const std::vector<Graph::edge_descriptor>& x) {
+    Graph g;
+    for (Graph::edges_size_type i = 0; i != x.size(); ++i)
+        add_edge(x[i].first, x[i].second, g);}
+
+// ---------------
+// build_one_arena
+// ---------------
+
+/**
+ * builds a graph with add_edge on its own arena and destroys both
+ * @param x : edges
+ */
+void build_one_arena (const std::vector<Graph::edge_descriptor>& x) {
+    ArenaResource r;
+    ArenaGraph    g((ArenaAllocator<unsigned int>(r)));
+    for (Graph::edges_size_type i = 0; i != x.size(); ++i)
+        add_edge(x[i].first, x[i].second, g);}
+
+// -------------
+// bench_threads
+// -------------
+
+/**
+ * builds and destroys one graph per thread, on the global heap and on arenas
+ * @param k : number of threads
+ * @param n : number of vertices per graph
+ * @param m : number of edges per graph
+ */
+void bench_threads (unsigned k, Graph::vertices_size_type n, Graph::edges_size_type m) {
+    const std::vector<Graph::edge_descriptor> x = random_edges(n, m);
+    std::vector<std::thread> t;
+
+    std::chrono::steady_clock::time_point b = std::chrono::steady_clock::now();
+    for (unsigned i = 0; i != k; ++i)
+        t.push_back(std::thread(build_one, std::cref(x)));
+    for (unsigned i = 0; i != k; ++i)
+        t[i].join();
+    const double h = elapsed(b);
+
+    t.clear();
+    b = std::chrono::steady_clock::now();
+    for (unsigned i = 0; i != k; ++i)
+        t.push_back(std::thread(build_one_arena, std::cref(x)));
+    for (unsigned i = 0; i != k; ++i)
+        t[i].join();
+    const double a = elapsed(b);
+
+    Record("threads").add("threads", k).add("vertices", n).add("edges", m)
+        .add("heap_ns_per_edge", h / (k * m)).add("arena_ns_per_edge", a / (k * m));}
+
+// -------------
+// time_parallel
+// -------------
+
+/**
+ * times the serial and parallel traversals across thread counts
+ * @param shape : name of the graphs' generator
+ * @param g : graph to search from vertex 0
+ * @param d : DAG to sort
+ */
+void time_parallel (const char* shape, const CompressedGraph& g, const CompressedGraph& d) {
+    const CompressedGraph::vertices_size_type n = num_vertices(g);
+    const CompressedGraph::edges_size_type    m = num_edges(g);
+
+    std::vector<CompressedGraph::vertex_descriptor> y;
+    y.reserve(n);
+    std::chrono::steady_clock::time_point b = std::chrono::steady_clock::now();
+    breadth_first_search(g, 0, std::back_inserter(y));
+    const double bfs = elapsed(b);
+
+    y.clear();
+    b = std::chrono::steady_clock::now();
+    topological_sort(d, std::back_inserter(y));
+    const double topo = elapsed(b);
+
+    Record("parallel").add("shape", shape).add("mode", "serial").add("threads", 0).add("vertices", n).add("edges", m)
+        .add("bfs_ms", bfs / 1e6).add("topo_ms", topo / 1e6);
+
+    for (unsigned k = 1; k <= 8; k *= 2) {
+        b = std::chrono::steady_clock::now();
+        parallel_breadth_first_search(g, 0, k);
+        const double pbfs = elapsed(b);
+
+        y.clear();
+        b = std::chrono::steady_clock::now();
+        parallel_topological_sort(d, std::back_inserter(y), k);
+        const double ptopo = elapsed(b);
+
+        Record("parallel").add("shape", shape).add("mode", "parallel").add("threads", k).add("vertices", n).add("edges", m)
+            .add("bfs_ms", pbfs / 1e6).add("topo_ms", ptopo / 1e6);}}
+
+// --------------
+// bench_parallel
+// --------------
+
+/**
+ * times the traversals on a uniform random graph, with the same edges
+ * oriented into a DAG for the sort, and on a chain of n vertices, whose
+ * one-vertex levels are the worst case for a level-synchronous algorithm
+ * @param n : number of vertices
+ * @param m : number of edges of the random graph
+ */
+void bench_parallel (Graph::vertices_size_type n, Graph::edges_size_type m) {
+    std::vector<Graph::edge_descriptor> x = random_edges(n, m);
+    const CompressedGraph g = freeze(Graph::from_edges(x.begin(), x.end(), n));
+    for (Graph::edges_size_type i = 0; i != x.size(); ++i)
+        if (x[i].first > x[i].second)
+            std::swap(x[i].first, x[i].second);
+        else if (x[i].first == x[i].second)
+            x[i].second = n - 1;
+    const CompressedGraph d = freeze(Graph::from_edges(x.begin(), x.end(), n));
+    time_parallel("uniform", g, d);
+
+    x = chain_edges(n);
+    const CompressedGraph c = freeze(Graph::from_edges(x.begin(), x.end(), n));
+    time_parallel("chain", c, c);}
+
+// -----
+// sweep
+// -----
+
+/**
+ * @param g : input graph
+ * @return : sum of all targets, so that reading every row is not optimized away
+ */
+template <typename G>
+unsigned long long sweep (const G& g) {
+    unsigned long long r = 0;
+    for (typename G::vertices_size_type v = 0; v != num_vertices(g); ++v) {
+        typename G::adjacency_iterator b = adjacent_vertices(v, g).first;
+        typename G::adjacency_iterator e = adjacent_vertices(v, g).second;
+        for (; b != e; ++b)
+            r += *b;}
+    return r;}
+
+// ----------
+// drop_cache
+// ----------
+
+/**
+ * evicts a file from the page cache: its dirty pages are written back
+ * first, since POSIX_FADV_DONTNEED leaves those resident, and then
+ * mincore confirms that no page is left
+ * @param path : file
+ * @return : true if none of the file is resident afterwards
+ */
+bool drop_cache (const std::string& path) {
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+    bool        r = (::fdatasync(fd) == 0) && (::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED) == 0);
+    struct stat st;
+    if (r && (::fstat(fd, &st) == 0) && (st.st_size > 0)) {
+        void* p = ::mmap(0, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        if (p == MAP_FAILED)
+            r = false;
+        else {
+            const long                 page = ::sysconf(_SC_PAGESIZE);
+            std::vector<unsigned char> v((st.st_size + page - 1) / page);
+            r = (::mincore(p, st.st_size, v.data()) == 0);
+            for (std::size_t i = 0; r && (i != v.size()); ++i)
+                r = (v[i] & 1) == 0;
+            ::munmap(p, st.st_size);}}
+    ::close(fd);
+    return r;}
+
+// ----------
+// bench_file
+// ----------
+
+/**
+ * times opening a saved graph file, cold (pages dropped from the cache
+ * first) and warm, with and without checksums, against building the graph
+ * from its edge list; "cold" is false if the cache could not be dropped,
+ * and then the cold timings are warm ones
+ * @param n : number of vertices
+ * @param m : number of edges
+ */
+void bench_file (Graph::vertices_size_type n, Graph::edges_size_type m) {
+    const std::string path = "BenchGraph.bin";
+    const std::vector<Graph::edge_descriptor> x = random_edges(n, m);
+
+    std::chrono::steady_clock::time_point b = std::chrono::steady_clock::now();
+    Graph g;
+    for (Graph::edges_size_type i = 0; i != x.size(); ++i)
+        add_edge(x[i].first, x[i].second, g);
+    const double a = elapsed(b);
+
+    b = std::chrono::steady_clock::now();
+    const CompressedGraph c = freeze(Graph::from_edges(x.begin(), x.end(), n));
+    const double f = elapsed(b);
+    save(c, path);
+    const unsigned long long expected = sweep(c);
+
+    const char* names[] = {"cold_nocheck", "warm_nocheck", "cold_verify", "warm_verify"};
+    double      t[4];
+    bool        cold = true;
+    for (int i = 0; i != 4; ++i) {
+        if ((i % 2 == 0) && !drop_cache(path))
+            cold = false;
+        b = std::chrono::steady_clock::now();
+        const MappedGraph h = load_mapped(path, i >= 2);
+        if (sweep(h) != expected)
+            std::cerr << "bench_file: mapped graph differs" << std::endl;
+        t[i] = elapsed(b);}
+    std::remove(path.c_str());
+
+    Record r("file");
+    r.add("vertices", n).add("edges", m).add("cold", cold).add("add_edge_ms", a / 1e6).add("from_edges_freeze_ms", f / 1e6);
+    for (int i = 0; i != 4; ++i)
+        r.add((std::string(names[i]) + "_load_and_sweep_ms").c_str(), t[i] / 1e6);}
+
+// ----
+// main
+// ----
+
+/**
+ * "BenchGraph quick" stops at 10^5 edges
+ */
+int main (int argc, char* argv[]) {
+    const bool quick = (argc > 1) && (std::strcmp(argv[1], "quick") == 0);
+    const Graph::edges_size_type top = quick ? 100000 : 10000000;
+
+    for (Graph::edges_size_type m = 10000; m <= top / 10; m *= 10) {
+        const Graph::vertices_size_type n = m / 10;
+        bench_both_types("uniform",   n, random_edges(n, m));
+        bench_both_types("power_law", n, rmat_edges(n, m));
+        bench_both_types("chain",     m, chain_edges(m));}
+
+    for (Graph::edges_size_type m = 100000; m <= top; m *= 10)
+        bench_build(m / 10, m);
+
+    for (unsigned k = 1; k <= 8; k *= 2)
+        bench_threads(k, top / 100, top / 10);
+
+    for (Graph::edges_size_type m = top / 10; m <= top; m *= 10)
+        bench_parallel(m / 10, m);
+
+    for (Graph::edges_size_type m = top / 10; m <= top; m *= 10)
+        bench_file(m / 10, m);
+    return 0;}
@@ -0,0 +1,130 @@
+// ----------------------------
+// projects/graph/CountingNew.h
+// ----------------------------
+
+#ifndef CountingNew_h
+#define CountingNew_h
+
+/*
+Replaces the global operator new and operator delete, every form, with ones
+that count what is requested and what is freed, and forward to malloc and
+free; each block carries its size in a header just before it. Replacement
+functions cannot be inline, so include this in exactly one translation unit
+of a program: the test or the benchmark driver, never a library header.
+
+Every form is replaced, not just the scalar one, so that a block is always
+freed by the family that allocated it; that is what valgrind and
+AddressSanitizer check, and libstdc++ calls the sized forms itself.
+*/
+
+// --------
+// includes
+// --------
+
+#include <atomic>  // atomic
+#include <cstddef> // max_align_t, size_t
+#include <cstdlib> // free, malloc
+#include <new>     // bad_alloc, nothrow_t
+
+// ----------
+// allocation
+// ----------
+
+// bytes and blocks requested from operator new, and bytes given back to operator
+// delete, since the start of the program, so a test or benchmark can measure what
+// a graph allocates, or holds, by differencing them
+static std::atomic<std::size_t> allocated_bytes(0);
+static std::atomic<std::size_t> allocated_blocks(0);
+static std::atomic<std::size_t> freed_bytes(0);
+
+// size of the header in front of each block, which keeps the block aligned
+static const std::size_t counting_header = alignof(std::max_align_t);
+
+// ----------
+// live_bytes
+// ----------
+
+/**
+ * @return : bytes allocated and not yet freed
+ */
+inline std::size_t live_bytes () {
+    return allocated_bytes - freed_bytes;}
+
+// ---------------
+// counting_malloc
+// ---------------
+
+/**
+ * @param n : bytes
+ * @return : a block from malloc, counted, or 0 if there is none
+ */
+static void* counting_malloc (std::size_t n) noexcept {
+    char* p = static_cast<char*>(std::malloc(counting_header + n));
+    if (!p)
+        return 0;
+    *reinterpret_cast<std::size_t*>(p) = n;
+    allocated_bytes  += n;
+    allocated_blocks += 1;
+    return p + counting_header;}
+
+// -------------
+// counting_free
+// -------------
+
+/**
+ * kept out of line, so the compiler does not see operator delete step
+ * back from the pointer operator new returned and warn about it
+ * @param p : a block from counting_malloc, or 0
+ */
+__attribute__((noinline)) static void counting_free (void* p) noexcept {
+    if (!p)
+        return;
+    char* b = static_cast<char*>(p) - counting_header;
+    freed_bytes += *reinterpret_cast<std::size_t*>(b);
+    std::free(b);}
+
+// ------------
+// operator new
+// ------------
+
+void* operator new (std::size_t n) {
+    void* p = counting_malloc(n);
+    if (!p)
+        throw std::bad_alloc();
+    return p;}
+
+void* operator new[] (std::size_t n) {
+    void* p = counting_malloc(n);
+    if (!p)
+        throw std::bad_alloc();
+    return p;}
+
+void* operator new (std::size_t n, const std::nothrow_t&) noexcept {
+    return counting_malloc(n);}
+
+void* operator new[] (std::size_t n, const std::nothrow_t&) noexcept {
+    return counting_malloc(n);}
+
+// ---------------
+// operator delete
+// ---------------
+
+void operator delete (void* p) noexcept {
+    counting_free(p);}
+
+void operator delete[] (void* p) noexcept {
+    counting_free(p);}
+
+void operator delete (void* p, std::size_t) noexcept {
+    counting_free(p);}
+
+void operator delete[] (void* p, std::size_t) noexcept {
+    counting_free(p);}
+
+void operator delete (void* p, const std::nothrow_t&) noexcept {
+    counting_free(p);}
+
+void operator delete[] (void* p, const std::nothrow_t&) noexcept {
+    counting_free(p);}
+
+#endif // CountingNew_h
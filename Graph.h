@@ -11,17 +11,161 @@
 // includes
 // --------
 
-#include <cassert> // assert
-#include <cstddef> // size_t
-#include <utility> // make_pair, pair
-#include <vector>  // vector
+#include <algorithm>  // binary_search, copy, find_if, is_sorted, max, min, sort
+#include <atomic>     // atomic
+#include <cassert>    // assert
+#include <condition_variable> // condition_variable
+#include <cstddef>    // max_align_t, offsetof, ptrdiff_t, size_t
+#include <cstdint>    // uint32_t, uint64_t
+#include <cstdio>     // remove, rename
+#include <cstring>    // memcmp, memcpy
+#include <fstream>    // ofstream
+#include <functional> // hash, less
+#include <iterator>   // forward_iterator_tag, output_iterator_tag
+#include <memory>     // allocator, allocator_traits, make_shared, shared_ptr
+#include <mutex>      // lock_guard, mutex, unique_lock
+#include <utility>    // make_pair, move, pair
+#include <vector>     // vector
 #include <set>
+#include <stdexcept>  // invalid_argument, runtime_error
+#include <string>     // string, to_string
+#include <thread>     // thread, this_thread
 
-// -----
-// Graph
-// -----
+#include <fcntl.h>    // open
+#include <sys/mman.h> // mmap, munmap
+#include <sys/stat.h> // fstat
+#include <unistd.h>   // close, fsync, getpid
+
+// ----------------
+// CountingIterator
+// ----------------
+
+/**
+ * Forward iterator over the integers [b, e), used as a vertex range that
+ * needs no backing container.
+ */
+class CountingIterator {
+    public:
+        // --------
+        // typedefs
+        // --------
+
+        typedef std::forward_iterator_tag iterator_category;
+        typedef unsigned int              value_type;
+        typedef std::ptrdiff_t            difference_type;
+        typedef const unsigned int*       pointer;
+        typedef unsigned int              reference;
+
+    private:
+        // ----
+        // data
+        // ----
+
+        value_type _v;
+
+    public:
+        // -----------
+        // constructor
+        // -----------
+
+        /**
+         * @param v : the current value
+         */
+        explicit CountingIterator (value_type v = 0) :
+            _v(v)
+            {}
+
+        // ----------
+        // operator *
+        // ----------
+
+        reference operator * () const {
+            return _v;}
+
+        // -----------
+        // operator ++
+        // -----------
+
+        CountingIterator& operator ++ () {
+            ++_v;
+            return *this;}
+
+        CountingIterator operator ++ (int) {
+            CountingIterator x = *this;
+            ++*this;
+            return x;}
+
+        // -----------
+        // operator ==
+        // -----------
+
+        friend bool operator == (const CountingIterator& lhs, const CountingIterator& rhs) {
+            return lhs._v == rhs._v;}
+
+        // -----------
+        // operator !=
+        // -----------
+
+        friend bool operator != (const CountingIterator& lhs, const CountingIterator& rhs) {
+            return !(lhs == rhs);}};
 
-class Graph {
+// -------------
+// parallel_sort
+// -------------
+
+/**
+ * std::sort split across threads: each thread sorts one slice, then
+ * neighbouring slices are merged pairwise, also in parallel.
+ * @param b : begin of a random access range
+ * @param e : end of the range
+ * @param k : number of threads, 0 for hardware_concurrency
+ */
+template <typename RI>
+void parallel_sort (RI b, RI e, unsigned k = 0) {
+    const std::size_t grain = 1 << 16;
+    const std::size_t n     = e - b;
+    if (k == 0)
+        k = std::thread::hardware_concurrency();
+    if (k > n / grain)
+        k = n / grain;
+    if (k <= 1) {
+        std::sort(b, e);
+        return;}
+
+    std::vector<RI> p;
+    for (unsigned i = 0; i != k; ++i)
+        p.push_back(b + n * i / k);
+    p.push_back(e);
+
+    std::vector<std::thread> t;
+    for (unsigned i = 0; i != k; ++i)
+        t.push_back(std::thread([&p, i] () {std::sort(p[i], p[i + 1]);}));
+    for (unsigned i = 0; i != k; ++i)
+        t[i].join();
+
+    while (p.size() > 2) {
+        std::vector<RI> q;
+        t.clear();
+        for (std::size_t i = 0; i + 2 < p.size(); i += 2) {
+            q.push_back(p[i]);
+            t.push_back(std::thread([&p, i] () {std::inplace_merge(p[i], p[i + 1], p[i + 2]);}));}
+        if (p.size() % 2 == 0)
+            q.push_back(p[p.size() - 2]);
+        q.push_back(e);
+        for (std::size_t i = 0; i != t.size(); ++i)
+            t[i].join();
+        p.swap(q);}}
+
+// ----------
+// BasicGraph
+// ----------
+
+/**
+ * Graph whose adjacency sets and their nodes come from an allocator of type A;
+ * see Graph and ArenaGraph below.
+ */
+template <typename A = std::allocator<unsigned int> >
+class BasicGraph {
     public:
         // --------
         // typedefs
@@ -30,13 +174,120 @@ class Graph {
         typedef unsigned int vertex_descriptor; 
         typedef std::pair<vertex_descriptor, vertex_descriptor> edge_descriptor;
 
-        typedef std::vector<vertex_descriptor>::const_iterator vertex_iterator;
-        typedef std::set<edge_descriptor>::const_iterator edge_iterator; 
-        typedef std::set<vertex_descriptor>::const_iterator adjacency_iterator;
+        typedef A allocator_type;
+        typedef typename std::allocator_traits<A>::template rebind_alloc<vertex_descriptor> vertex_allocator;
+        typedef std::set<vertex_descriptor, std::less<vertex_descriptor>, vertex_allocator> adjacency_set;
+        typedef typename std::allocator_traits<A>::template rebind_alloc<adjacency_set> set_allocator;
+
+        typedef CountingIterator vertex_iterator;
+        typedef typename adjacency_set::const_iterator adjacency_iterator;
 
         typedef std::size_t vertices_size_type;
         typedef std::size_t edges_size_type;
 
+        // -------------
+        // edge_iterator
+        // -------------
+
+        /**
+         * Flattens the adjacency sets into (source, target) order; edges are
+         * stored only once, in the adjacency set of their source.
+         */
+        class edge_iterator {
+            public:
+                // --------
+                // typedefs
+                // --------
+
+                typedef std::forward_iterator_tag iterator_category;
+                typedef edge_descriptor           value_type;
+                typedef std::ptrdiff_t            difference_type;
+                typedef const edge_descriptor*    pointer;
+                typedef edge_descriptor           reference;
+
+            private:
+                // --------
+                // typedefs
+                // --------
+
+                typedef typename std::vector<adjacency_set, set_allocator>::const_iterator outer_iterator;
+
+                // ----
+                // data
+                // ----
+
+                outer_iterator     _b;
+                outer_iterator     _e;
+                vertex_descriptor  _s;
+                adjacency_iterator _i;
+
+                // ----
+                // skip
+                // ----
+
+                /**
+                 * moves past empty adjacency sets to the next edge, or to the end
+                 */
+                void skip () {
+                    while ((_b != _e) && (_i == _b->end())) {
+                        ++_b;
+                        ++_s;
+                        if (_b != _e)
+                            _i = _b->begin();}}
+
+            public:
+                // -----------
+                // constructor
+                // -----------
+
+                /**
+                 * @param b : adjacency set of vertex s
+                 * @param e : end of the adjacency sets
+                 * @param s : vertex_descriptor of b
+                 */
+                edge_iterator (outer_iterator b = outer_iterator(), outer_iterator e = outer_iterator(), vertex_descriptor s = 0) :
+                        _b(b),
+                        _e(e),
+                        _s(s) {
+                    if (_b != _e) {
+                        _i = _b->begin();
+                        skip();}}
+
+                // ----------
+                // operator *
+                // ----------
+
+                reference operator * () const {
+                    return std::make_pair(_s, *_i);}
+
+                // -----------
+                // operator ++
+                // -----------
+
+                edge_iterator& operator ++ () {
+                    ++_i;
+                    skip();
+                    return *this;}
+
+                edge_iterator operator ++ (int) {
+                    edge_iterator x = *this;
+                    ++*this;
+                    return x;}
+
+                // -----------
+                // operator ==
+                // -----------
+
+                friend bool operator == (const edge_iterator& lhs, const edge_iterator& rhs) {
+                    return (lhs._b == rhs._b) && ((lhs._b == lhs._e) || (lhs._i == rhs._i));}
+
+                // -----------
+                // operator !=
+                // -----------
+
+                friend bool operator != (const edge_iterator& lhs, const edge_iterator& rhs) {
+                    return !(lhs == rhs);}};
+
     public:
         // --------
         // add_edge
@@ -48,20 +299,55 @@ class Graph {
          * @param g : graph 
          * @return : pair<edge_descriptor, bool>, bool dependent on successful creation of an edge
          */
-        friend std::pair<edge_descriptor, bool> add_edge (vertex_descriptor s, vertex_descriptor t, Graph& g) {
+        friend std::pair<edge_descriptor, bool> add_edge (vertex_descriptor s, vertex_descriptor t, BasicGraph& g) {
             // Allows the transfer of vertices from one graph to the other
-            while(g._v.size() <= s)
+            while(g._g.size() <= s)
                 add_vertex(g);
-            while(g._v.size() <= t) 
+            while(g._g.size() <= t) 
                 add_vertex(g);
 
             edge_descriptor e = std::make_pair(s, t); 
             std::pair<adjacency_iterator, bool> a = g._g[s].insert(t);
             if(a.second) 
-                g._e.insert(e);
+                ++g._num_edges;
             return std::make_pair(e, a.second);
         }
 
+        // ----------
+        // from_edges
+        // ----------
+
+        /**
+         * builds a graph from a list of edges in one pass: the list is sorted
+         * and deduplicated (in parallel for large lists), then each adjacency
+         * set is filled in order with end() hints, so nothing is rebalanced
+         * @param b : begin of a range of (source, target) pairs
+         * @param e : end of the range
+         * @param n : number of vertices; raised if an edge names a larger vertex
+         * @param a : allocator for the adjacency sets
+         * @return : the graph
+         */
+        template <typename II>
+        static BasicGraph from_edges (II b, II e, vertices_size_type n = 0, const allocator_type& a = allocator_type()) {
+            std::vector<edge_descriptor> x(b, e);
+            parallel_sort(x.begin(), x.end());
+            x.erase(std::unique(x.begin(), x.end()), x.end());
+            for (edges_size_type i = 0; i != x.size(); ++i) {
+                if (n <= x[i].first)
+                    n = x[i].first + 1;
+                if (n <= x[i].second)
+                    n = x[i].second + 1;}
+
+            BasicGraph g(a);
+            g._g.reserve(n);
+            while (g._g.size() < n)
+                add_vertex(g);
+            for (edges_size_type i = 0; i != x.size(); ++i)
+                g._g[x[i].first].insert(g._g[x[i].first].end(), x[i].second);
+            g._num_edges = x.size();
+            assert(g.valid());
+            return g;}
+
         // ----------
         // add_vertex
         // ----------
@@ -70,12 +356,74 @@ class Graph {
          * @param g : reference to a graph
          * @return v : new vertex that was added
          */
-        friend vertex_descriptor add_vertex (Graph& g) {
+        friend vertex_descriptor add_vertex (BasicGraph& g) {
             vertex_descriptor v = g._g.size(); // ! new vertex value is the size of the graph
-            g._v.push_back(v); //added vertex to graph vertices container
-            g._g.push_back(std::set<vertex_descriptor>()); // new adjacency matrix for a graph
+            g._g.push_back(adjacency_set(std::less<vertex_descriptor>(), vertex_allocator(g._g.get_allocator()))); // new adjacency matrix for a graph
             return v;}
 
+        // -----------
+        // remove_edge
+        // -----------
+
+        /**
+         * removes (s, t) if it is there, O(log(out_degree(s)))
+         * @param s : vertex_descriptor, source
+         * @param t : vertex_descriptor, target
+         * @param g : graph
+         */
+        friend void remove_edge (vertex_descriptor s, vertex_descriptor t, BasicGraph& g) {
+            if (s < g._g.size())
+                g._num_edges -= g._g[s].erase(t);}
+
+        /**
+         * @param e : edge
+         * @param g : graph
+         */
+        friend void remove_edge (edge_descriptor e, BasicGraph& g) {
+            remove_edge(e.first, e.second, g);}
+
+        // ------------
+        // clear_vertex
+        // ------------
+
+        /**
+         * removes every edge into or out of v; the in-edges are found by
+         * looking v up in every adjacency set, O(V log(E / V))
+         * @param v : vertex_descriptor
+         * @param g : graph
+         */
+        friend void clear_vertex (vertex_descriptor v, BasicGraph& g) {
+            g._num_edges -= g._g[v].size();
+            g._g[v].clear();
+            for (vertices_size_type u = 0; u != g._g.size(); ++u)
+                g._num_edges -= g._g[u].erase(v);
+            assert(g.valid());}
+
+        // -------------
+        // remove_vertex
+        // -------------
+
+        /**
+         * removes v and its edges; like boost::adjacency_list with vecS,
+         * every vertex after v is renumbered one lower, O(V + E)
+         * @param v : vertex_descriptor
+         * @param g : graph
+         */
+        friend void remove_vertex (vertex_descriptor v, BasicGraph& g) {
+            clear_vertex(v, g);
+            g._g.erase(g._g.begin() + v);
+            for (vertices_size_type u = 0; u != g._g.size(); ++u) {
+                adjacency_set& a = g._g[u];
+                typename adjacency_set::iterator b = a.upper_bound(v);
+                if (b == a.end())
+                    continue;
+                // decrementing keeps the order, so the renumbered tail goes back in with end() hints
+                std::vector<vertex_descriptor> x(b, a.end());
+                a.erase(b, a.end());
+                for (std::size_t i = 0; i != x.size(); ++i)
+                    a.insert(a.end(), x[i] - 1);}
+            assert(g.valid());}
+
         // -----------------
         // adjacent_vertices
         // -----------------
@@ -85,7 +433,7 @@ class Graph {
          * @param g : graph 
          * @return : iterator to the vector of adjacent vertices to v. 
          */
-        friend std::pair<adjacency_iterator, adjacency_iterator> adjacent_vertices (vertex_descriptor v, const Graph& g) {
+        friend std::pair<adjacency_iterator, adjacency_iterator> adjacent_vertices (vertex_descriptor v, const BasicGraph& g) {
             adjacency_iterator b = g._g[v].begin(); 
             adjacency_iterator e = g._g[v].end();
             return std::make_pair(b, e);}
@@ -99,28 +447,25 @@ class Graph {
          * @param t : vertex_descriptor, targer
          * @param g : graph, by reference
          * @return : std::pair<edge_descriptor, bool>, finds corresponding pair(s, t) in graph, false if not found
+         * looks only in the adjacency set of s, O(log(out_degree(s)))
          */
-        friend std::pair<edge_descriptor, bool> edge (vertex_descriptor s, vertex_descriptor t, const Graph& g) {
-            edge_descriptor e_ = std::make_pair(s, t); 
-            edge_iterator b = g._e.begin();
-            edge_iterator e = g._e.end();
-            while(b != e) {
-                if((*b).first == s && (*b).second == t) {
-                    return std::make_pair(e_, true);}
-                ++b;
-            }
-            return std::make_pair(e_, false);
-        }
+        friend std::pair<edge_descriptor, bool> edge (vertex_descriptor s, vertex_descriptor t, const BasicGraph& g) {
+            edge_descriptor e = std::make_pair(s, t);
+            if (s >= g._g.size())
+                return std::make_pair(e, false);
+            return std::make_pair(e, g._g[s].find(t) != g._g[s].end());}
+
         // -----
         // edges
         // -----
 
         /**
          * @param g : input graph
+         * @return : lazy iterators over all edges in (source, target) order
          */
-        friend std::pair<edge_iterator, edge_iterator> edges (const Graph& g) {
-            edge_iterator b = g._e.begin();
-            edge_iterator e = g._e.end();
+        friend std::pair<edge_iterator, edge_iterator> edges (const BasicGraph& g) {
+            edge_iterator b(g._g.begin(), g._g.end(), 0);
+            edge_iterator e(g._g.end(),   g._g.end(), g._g.size());
             return std::make_pair(b, e);}
 
         // ---------
@@ -130,8 +475,8 @@ class Graph {
         /**
          * @param g : input graph
          */
-        friend edges_size_type num_edges (const Graph& g) {
-            return g._e.size();}
+        friend edges_size_type num_edges (const BasicGraph& g) {
+            return g._num_edges;}
 
         // ------------
         // num_vertices
@@ -140,8 +485,20 @@ class Graph {
         /**
          * @param g : input graph
          */
-        friend vertices_size_type num_vertices (const Graph& g) {
-            return g._v.size();}
+        friend vertices_size_type num_vertices (const BasicGraph& g) {
+            return g._g.size();}
+
+        // ----------
+        // out_degree
+        // ----------
+
+        /**
+         * @param v : source vertex
+         * @param g : input graph
+         * @return : number of edges leaving v
+         */
+        friend edges_size_type out_degree (vertex_descriptor v, const BasicGraph& g) {
+            return g._g[v].size();}
 
         // ------
         // source
@@ -151,7 +508,7 @@ class Graph {
          * @param e : edge
          * @param g : input graph
          */
-        friend vertex_descriptor source (edge_descriptor e, const Graph&) {
+        friend vertex_descriptor source (edge_descriptor e, const BasicGraph&) {
             return e.first;}
 
         // ------
@@ -162,7 +519,7 @@ class Graph {
          * @param e : edge
          * @param g : input graph
          */
-        friend vertex_descriptor target (edge_descriptor e, const Graph&) {
+        friend vertex_descriptor target (edge_descriptor e, const BasicGraph&) {
             return e.second;}
 
         // ------
@@ -174,10 +531,8 @@ class Graph {
          * @param g : input graph
          * @return : vertex_descriptor value
          */
-        friend vertex_descriptor vertex (vertices_size_type idx, const Graph& g) {
-            if(idx >= g._v.size())
-                return idx;
-            return g._v[idx];}
+        friend vertex_descriptor vertex (vertices_size_type idx, const BasicGraph&) {
+            return idx;}
 
         // --------
         // vertices
@@ -185,11 +540,11 @@ class Graph {
 
         /**
          * @param g : input graph
-         * @return : the begining and end iterators to the vertices container
+         * @return : counting iterators over [0, num_vertices(g))
          */
-        friend std::pair<vertex_iterator, vertex_iterator> vertices (const Graph& g) {
-            vertex_iterator b = g._v.begin();
-            vertex_iterator e = g._v.end();
+        friend std::pair<vertex_iterator, vertex_iterator> vertices (const BasicGraph& g) {
+            vertex_iterator b(0);
+            vertex_iterator e(g._g.size());
             return std::make_pair(b, e);}
 
     private:
@@ -197,19 +552,21 @@ class Graph {
         // data
         // ----
 
-        std::vector< std::set<vertex_descriptor> > _g; // ! rename graph container
-        std::vector<vertex_descriptor> _v; // ! container for vertices
-        std::set<edge_descriptor> _e; // ! container for edges 
+        std::vector<adjacency_set, set_allocator> _g; // ! rename graph container, the only copy of each edge
+        edges_size_type _num_edges; // ! total size of the adjacency sets
         
         // -----
         // valid
         // -----
 
         /**
-         * @return : boolean value, indicates that all vertices are on the graph
+         * @return : boolean value, indicates that the edge count matches the adjacency sets
          */
         bool valid () const {
-            return _g.size() == _v.size();} 
+            edges_size_type n = 0;
+            for (vertices_size_type v = 0; v != _g.size(); ++v)
+                n += _g[v].size();
+            return n == _num_edges;} 
 
     public:
         // ------------
@@ -217,22 +574,2515 @@ class Graph {
         // ------------
 
         /**
-         * @param g : vector of sets that hold vertex_descriptors
-         * @param v : vector of vertex_descriptor, container for vertices
-         * @param e : vector of edge_descriptor, container for edges 
+         * @param a : allocator for the adjacency sets
          */
-        Graph (std::vector< std::set<vertex_descriptor> > g = std::vector< std::set<vertex_descriptor> >(),
-            std::vector<vertex_descriptor> v = std::vector<vertex_descriptor>(), 
-            std::set<edge_descriptor> e = std::set<edge_descriptor>()) :
-            _g(g),
-            _v(v),
-            _e(e) {
+        explicit BasicGraph (const allocator_type& a = allocator_type()) :
+                _g(set_allocator(a)),
+                _num_edges(0) {
+            assert(valid());}
+
+        /**
+         * @param g : vector of sets that hold vertex_descriptors, the adjacency set of each vertex
+         * @param a : allocator for the adjacency sets
+         */
+        explicit BasicGraph (const std::vector< std::set<vertex_descriptor> >& g, const allocator_type& a = allocator_type()) :
+                _g(set_allocator(a)),
+                _num_edges(0) {
+            _g.reserve(g.size());
+            for (vertices_size_type v = 0; v != g.size(); ++v) {
+                add_vertex(*this);
+                _g[v].insert(g[v].begin(), g[v].end());
+                _num_edges += g[v].size();}
             assert(valid());}
 
         // Default copy, destructor, and copy assignment
-        // Graph  (const Graph<T>&);
-        // ~Graph ();
-        // Graph& operator = (const Graph&);
+        // BasicGraph  (const BasicGraph&);
+        // ~BasicGraph ();
+        // BasicGraph& operator = (const BasicGraph&);
     };
 
+// -------------
+// ArenaResource
+// -------------
+
+/**
+ * Monotonic memory resource: hands out memory from large chunks and frees
+ * nothing until it is destroyed, so a graph built on it costs a handful of
+ * allocations and is torn down in one sweep. Not thread safe; give each
+ * thread its own.
+ */
+class ArenaResource {
+    private:
+        // ----
+        // data
+        // ----
+
+        std::vector<char*> _chunks; // ! every chunk, freed by the destructor
+        char*              _p;      // ! next free byte of the current chunk
+        std::size_t        _left;   // ! bytes left in the current chunk
+        std::size_t        _next;   // ! size of the next chunk
+
+    public:
+        // -----------
+        // constructor
+        // -----------
+
+        /**
+         * @param n : size of the first chunk, in bytes; later chunks double;
+         *            raised to alignof(std::max_align_t) if smaller, so 0 is fine
+         */
+        explicit ArenaResource (std::size_t n = 1 << 16) :
+            _p(0),
+            _left(0),
+            _next(std::max<std::size_t>(n, alignof(std::max_align_t)))
+            {}
+
+        ArenaResource (const ArenaResource&) = delete;
+        ArenaResource& operator = (const ArenaResource&) = delete;
+
+        // ----------
+        // destructor
+        // ----------
+
+        ~ArenaResource () {
+            for (std::size_t i = 0; i != _chunks.size(); ++i)
+                ::operator delete(_chunks[i]);}
+
+        // --------
+        // allocate
+        // --------
+
+        /**
+         * @param n : bytes
+         * @param a : alignment, a power of two
+         * @return : n bytes aligned to a
+         */
+        void* allocate (std::size_t n, std::size_t a) {
+            std::size_t pad = (a - reinterpret_cast<std::size_t>(_p) % a) % a;
+            if (_left < n + pad) {
+                while (_next < n + a)
+                    _next *= 2;
+                _chunks.push_back(static_cast<char*>(::operator new(_next)));
+                _p     = _chunks.back();
+                _left  = _next;
+                _next *= 2;
+                pad    = (a - reinterpret_cast<std::size_t>(_p) % a) % a;}
+            void* r = _p + pad;
+            _p    += n + pad;
+            _left -= n + pad;
+            return r;}
+
+        // ----------
+        // deallocate
+        // ----------
+
+        /**
+         * does nothing; memory comes back when the arena is destroyed
+         */
+        void deallocate (void*, std::size_t)
+            {}
+
+        // ------
+        // chunks
+        // ------
+
+        /**
+         * @return : number of chunks taken from operator new
+         */
+        std::size_t chunks () const {
+            return _chunks.size();}};
+
+// --------------
+// ArenaAllocator
+// --------------
+
+/**
+ * Standard allocator that draws from an ArenaResource.
+ */
+template <typename T>
+class ArenaAllocator {
+    template <typename U>
+    friend class ArenaAllocator;
+
+    public:
+        // --------
+        // typedefs
+        // --------
+
+        typedef T value_type;
+
+    private:
+        // ----
+        // data
+        // ----
+
+        ArenaResource* _r;
+
+    public:
+        // ------------
+        // constructors
+        // ------------
+
+        /**
+         * @param r : the arena, which must outlive every container using it
+         */
+        ArenaAllocator (ArenaResource& r) :
+            _r(&r)
+            {}
+
+        template <typename U>
+        ArenaAllocator (const ArenaAllocator<U>& x) :
+            _r(x._r)
+            {}
+
+        // --------
+        // allocate
+        // --------
+
+        T* allocate (std::size_t n) {
+            return static_cast<T*>(_r->allocate(n * sizeof(T), alignof(T)));}
+
+        // ----------
+        // deallocate
+        // ----------
+
+        void deallocate (T* p, std::size_t n) {
+            _r->deallocate(p, n * sizeof(T));}
+
+        // -----------
+        // operator ==
+        // -----------
+
+        template <typename U>
+        friend bool operator == (const ArenaAllocator& lhs, const ArenaAllocator<U>& rhs) {
+            return lhs._r == rhs._r;}
+
+        // -----------
+        // operator !=
+        // -----------
+
+        template <typename U>
+        friend bool operator != (const ArenaAllocator& lhs, const ArenaAllocator<U>& rhs) {
+            return lhs._r != rhs._r;}};
+
+// -----
+// Graph
+// -----
+
+typedef BasicGraph<> Graph;
+
+// ----------
+// ArenaGraph
+// ----------
+
+/**
+ * Graph on an ArenaResource:
+ *     ArenaResource r;
+ *     ArenaGraph    g((ArenaAllocator<unsigned int>(r)));
+ */
+typedef BasicGraph< ArenaAllocator<unsigned int> > ArenaGraph;
+
+
+// ---------------
+// CompressedGraph
+// ---------------
+
+/**
+ * Immutable compressed sparse row (CSR) snapshot of a directed graph.
+ * The targets of vertex v are _targets[_offsets[v]] .. _targets[_offsets[v + 1]],
+ * sorted ascending, so adjacency walks are sequential reads of one array.
+ */
+class CompressedGraph {
+    public:
+        // --------
+        // typedefs
+        // --------
+
+        typedef unsigned int vertex_descriptor;
+        typedef std::pair<vertex_descriptor, vertex_descriptor> edge_descriptor;
+
+        typedef std::size_t vertices_size_type;
+        typedef std::size_t edges_size_type;
+
+        typedef CountingIterator vertex_iterator;
+        typedef const vertex_descriptor* adjacency_iterator;
+
+        // -------------
+        // edge_iterator
+        // -------------
+
+        /**
+         * Walks the target array in order, tracking the source vertex whose
+         * row contains the current position.
+         */
+        class edge_iterator {
+            public:
+                // --------
+                // typedefs
+                // --------
+
+                typedef std::forward_iterator_tag iterator_category;
+                typedef edge_descriptor           value_type;
+                typedef std::ptrdiff_t            difference_type;
+                typedef const edge_descriptor*    pointer;
+                typedef edge_descriptor           reference;
+
+            private:
+                // ----
+                // data
+                // ----
+
+                const edges_size_type*   _offsets;
+                const vertex_descriptor* _targets;
+                vertices_size_type       _n;
+                vertex_descriptor        _s;
+                edges_size_type          _i;
+
+                // ----
+                // skip
+                // ----
+
+                /**
+                 * moves _s forward to the row that holds position _i
+                 */
+                void skip () {
+                    while ((_s < _n) && (_offsets[_s + 1] <= _i))
+                        ++_s;}
+
+            public:
+                // -----------
+                // constructor
+                // -----------
+
+                /**
+                 * @param o : offsets array, n + 1 entries
+                 * @param t : targets array
+                 * @param n : number of vertices
+                 * @param i : position in the targets array
+                 */
+                edge_iterator (const edges_size_type* o = 0, const vertex_descriptor* t = 0, vertices_size_type n = 0, edges_size_type i = 0) :
+                        _offsets(o),
+                        _targets(t),
+                        _n(n),
+                        _s(0),
+                        _i(i) {
+                    if (_offsets)
+                        skip();}
+
+                // ----------
+                // operator *
+                // ----------
+
+                reference operator * () const {
+                    return std::make_pair(_s, _targets[_i]);}
+
+                // -----------
+                // operator ++
+                // -----------
+
+                edge_iterator& operator ++ () {
+                    ++_i;
+                    skip();
+                    return *this;}
+
+                edge_iterator operator ++ (int) {
+                    edge_iterator x = *this;
+                    ++*this;
+                    return x;}
+
+                // -----------
+                // operator ==
+                // -----------
+
+                friend bool operator == (const edge_iterator& lhs, const edge_iterator& rhs) {
+                    return lhs._i == rhs._i;}
+
+                // -----------
+                // operator !=
+                // -----------
+
+                friend bool operator != (const edge_iterator& lhs, const edge_iterator& rhs) {
+                    return !(lhs == rhs);}};
+
+    public:
+        // -----------------
+        // adjacent_vertices
+        // -----------------
+
+        /**
+         * @param v : source vertex
+         * @param g : graph
+         * @return : pair of pointers delimiting the sorted targets of v
+         */
+        friend std::pair<adjacency_iterator, adjacency_iterator> adjacent_vertices (vertex_descriptor v, const CompressedGraph& g) {
+            adjacency_iterator b = g._targets.data() + g._offsets[v];
+            adjacency_iterator e = g._targets.data() + g._offsets[v + 1];
+            return std::make_pair(b, e);}
+
+        // ----
+        // edge
+        // ----
+
+        /**
+         * @param s : vertex_descriptor, source
+         * @param t : vertex_descriptor, target
+         * @param g : graph
+         * @return : std::pair<edge_descriptor, bool>, a bit test if s has a dense row, else a binary search of the row of s
+         */
+        friend std::pair<edge_descriptor, bool> edge (vertex_descriptor s, vertex_descriptor t, const CompressedGraph& g) {
+            edge_descriptor e = std::make_pair(s, t);
+            if (s >= num_vertices(g))
+                return std::make_pair(e, false);
+            if (!g._dense.empty() && (g._dense[s] != no_row)) {
+                if (t >= num_vertices(g))
+                    return std::make_pair(e, false);
+                const std::size_t w = g._dense[s] * g._words + t / word_bits;
+                return std::make_pair(e, ((g._bits[w] >> (t % word_bits)) & 1) != 0);}
+            std::pair<adjacency_iterator, adjacency_iterator> p = adjacent_vertices(s, g);
+            return std::make_pair(e, std::binary_search(p.first, p.second, t));}
+
+        // -----
+        // edges
+        // -----
+
+        /**
+         * @param g : input graph
+         * @return : iterators over all edges in (source, target) order
+         */
+        friend std::pair<edge_iterator, edge_iterator> edges (const CompressedGraph& g) {
+            const vertices_size_type n = num_vertices(g);
+            edge_iterator b(g._offsets.data(), g._targets.data(), n, 0);
+            edge_iterator e(g._offsets.data(), g._targets.data(), n, g._targets.size());
+            return std::make_pair(b, e);}
+
+        // ---------
+        // num_edges
+        // ---------
+
+        /**
+         * @param g : input graph
+         */
+        friend edges_size_type num_edges (const CompressedGraph& g) {
+            return g._targets.size();}
+
+        // ------------
+        // num_vertices
+        // ------------
+
+        /**
+         * @param g : input graph
+         */
+        friend vertices_size_type num_vertices (const CompressedGraph& g) {
+            return g._offsets.size() - 1;}
+
+        // ----------
+        // out_degree
+        // ----------
+
+        /**
+         * @param v : source vertex
+         * @param g : input graph
+         * @return : number of edges leaving v
+         */
+        friend edges_size_type out_degree (vertex_descriptor v, const CompressedGraph& g) {
+            return g._offsets[v + 1] - g._offsets[v];}
+
+        // ------
+        // source
+        // ------
+
+        /**
+         * @param e : edge
+         * @param g : input graph
+         */
+        friend vertex_descriptor source (edge_descriptor e, const CompressedGraph&) {
+            return e.first;}
+
+        // ------
+        // target
+        // ------
+
+        /**
+         * @param e : edge
+         * @param g : input graph
+         */
+        friend vertex_descriptor target (edge_descriptor e, const CompressedGraph&) {
+            return e.second;}
+
+        // ------
+        // vertex
+        // ------
+
+        /**
+         * @param idx : vertex_descriptor value
+         * @param g : input graph
+         * @return : vertex_descriptor value
+         */
+        friend vertex_descriptor vertex (vertices_size_type idx, const CompressedGraph&) {
+            return idx;}
+
+        // --------
+        // vertices
+        // --------
+
+        /**
+         * @param g : input graph
+         * @return : counting iterators over [0, num_vertices(g))
+         */
+        friend std::pair<vertex_iterator, vertex_iterator> vertices (const CompressedGraph& g) {
+            vertex_iterator b(0);
+            vertex_iterator e(num_vertices(g));
+            return std::make_pair(b, e);}
+
+    private:
+        // ----
+        // data
+        // ----
+
+        static const std::size_t no_row    = static_cast<std::size_t>(-1);
+        static const std::size_t word_bits = sizeof(unsigned long) * 8;
+
+        std::vector<edges_size_type>   _offsets; // ! row starts, num_vertices + 1 entries
+        std::vector<vertex_descriptor> _targets; // ! row contents, sorted per vertex
+        std::vector<std::size_t>       _dense;   // ! bitset row of each vertex, no_row if none; empty if no index
+        std::vector<unsigned long>     _bits;    // ! bitset rows, _words words each
+        std::size_t                    _words;   // ! words per bitset row
+
+        // -----
+        // index
+        // -----
+
+        /**
+         * gives every vertex with at least d out-edges a bitset row over all vertices
+         * @param d : out-degree threshold, 0 for no index
+         */
+        void index (edges_size_type d) {
+            const vertices_size_type n = num_vertices(*this);
+            if (d == 0)
+                return;
+            _words = (n + word_bits - 1) / word_bits;
+            _dense.assign(n, static_cast<std::size_t>(no_row));
+            std::size_t r = 0;
+            for (vertices_size_type v = 0; v != n; ++v)
+                if (out_degree(v, *this) >= d)
+                    _dense[v] = r++;
+            if (r == 0) {
+                _dense.clear();
+                return;}
+            _bits.assign(r * _words, 0);
+            for (vertices_size_type v = 0; v != n; ++v) {
+                if (_dense[v] == no_row)
+                    continue;
+                unsigned long* row = &_bits[_dense[v] * _words];
+                for (edges_size_type i = _offsets[v]; i != _offsets[v + 1]; ++i)
+                    row[_targets[i] / word_bits] |= 1UL << (_targets[i] % word_bits);}}
+
+        // -----
+        // valid
+        // -----
+
+        /**
+         * @return : boolean value, offsets are monotone and cover the targets
+         */
+        bool valid () const {
+            if (_offsets.empty() || (_offsets.front() != 0) || (_offsets.back() != _targets.size()))
+                return false;
+            for (vertices_size_type v = 1; v != _offsets.size(); ++v)
+                if (_offsets[v - 1] > _offsets[v])
+                    return false;
+            return true;}
+
+    public:
+        // ------------
+        // constructors
+        // ------------
+
+        /**
+         * empty graph
+         */
+        CompressedGraph () :
+            _offsets(1, 0),
+            _words(0)
+            {}
+
+        /**
+         * @param g : any graph modeling vertices, num_vertices, num_edges, and adjacent_vertices
+         * @param d : out-degree at or above which a vertex also gets a bitset row, making edge() O(1) for it; 0 for none
+         * each bitset row costs num_vertices / 8 bytes, so d should be a sizable fraction of num_vertices / 32
+         */
+        template <typename G>
+        explicit CompressedGraph (const G& g, edges_size_type d = 0) :
+                _offsets(1, 0),
+                _words(0) {
+            _offsets.reserve(num_vertices(g) + 1);
+            _targets.reserve(num_edges(g));
+            typename G::vertex_iterator b = vertices(g).first;
+            typename G::vertex_iterator e = vertices(g).second;
+            while (b != e) {
+                typename G::adjacency_iterator ab = adjacent_vertices(*b, g).first;
+                typename G::adjacency_iterator ae = adjacent_vertices(*b, g).second;
+                while (ab != ae) {
+                    _targets.push_back(*ab);
+                    ++ab;}
+                std::sort(_targets.begin() + _offsets.back(), _targets.end());
+                _offsets.push_back(_targets.size());
+                ++b;}
+            index(d);
+            assert(valid());}
+
+        // Default copy, destructor, and copy assignment
+        // CompressedGraph  (const CompressedGraph&);
+        // ~CompressedGraph ();
+        // CompressedGraph& operator = (const CompressedGraph&);
+    };
+
+// ------
+// freeze
+// ------
+
+/**
+ * @param g : input graph
+ * @param d : out-degree threshold for the bitset edge index, 0 for none
+ * @return : an immutable CSR copy of g
+ */
+template <typename G>
+CompressedGraph freeze (const G& g, typename CompressedGraph::edges_size_type d = 0) {
+    return CompressedGraph(g, d);}
+
+// ----------------
+// sorted_adjacency
+// ----------------
+
+/**
+ * value is true if adjacent_vertices of G always yields each row in
+ * ascending order, which lets edges_exist merge against the row in place;
+ * specialize it for other such types, e.g. a setS adjacency_list
+ */
+template <typename G>
+struct sorted_adjacency {
+    enum {value = false};};
+
+template <typename A>
+struct sorted_adjacency< BasicGraph<A> > {
+    enum {value = true};};
+
+template <>
+struct sorted_adjacency<CompressedGraph> {
+    enum {value = true};};
+
+// --------------------
+// merge_sorted_queries
+// --------------------
+
+/**
+ * @param ab : begin of a row, ascending
+ * @param ae : end of the row
+ * @param b : begin of queries of that row's source, ascending by target
+ * @param e : end of the queries
+ * @param r : receives, at each query's index, whether its target is in the row
+ */
+template <typename AI, typename Q>
+void merge_sorted_queries (AI ab, AI ae, const Q* b, const Q* e, std::vector<char>& r) {
+    for (; b != e; ++b) {
+        while ((ab != ae) && (*ab < b->first.second))
+            ++ab;
+        r[b->second] = (ab != ae) && (*ab == b->first.second);}}
+
+// -----------
+// edges_exist
+// -----------
+
+/**
+ * Answers a batch of edge queries in one pass over the affected rows.
+ * Queries are sorted; a source with many queries relative to its out-degree
+ * is answered by merging the queries against its adjacency, in place if
+ * sorted_adjacency<G> says the row is ascending, else against a sorted copy
+ * of the row; other sources fall back to edge().
+ * @param b : begin of a range of (source, target) pairs
+ * @param e : end of the range
+ * @param x : output iterator, receives one bool per query in input order
+ * @param g : input graph
+ * @return : x advanced past the last result
+ */
+template <typename G, typename II, typename OI>
+OI edges_exist (II b, II e, OI x, const G& g) {
+    typedef typename G::vertex_descriptor  vertex_descriptor;
+    typedef typename G::adjacency_iterator adjacency_iterator;
+    typedef std::pair<std::pair<vertex_descriptor, vertex_descriptor>, std::size_t> query;
+
+    std::vector<query> q;
+    while (b != e) {
+        q.push_back(std::make_pair(std::make_pair((*b).first, (*b).second), q.size()));
+        ++b;}
+    std::sort(q.begin(), q.end());
+
+    std::vector<char>              r(q.size(), 0);
+    std::vector<vertex_descriptor> row; // ! reused for rows that must be sorted first
+    const std::size_t              n = num_vertices(g);
+    std::size_t i = 0;
+    while (i != q.size()) {
+        const vertex_descriptor s = q[i].first.first;
+        std::size_t j = i;
+        while ((j != q.size()) && (q[j].first.first == s))
+            ++j;
+        if (s >= n) {
+            i = j;
+            continue;}
+        if ((j - i) * 8 >= static_cast<std::size_t>(out_degree(s, g))) {
+            adjacency_iterator ab = adjacent_vertices(s, g).first;
+            adjacency_iterator ae = adjacent_vertices(s, g).second;
+            if (sorted_adjacency<G>::value)
+                merge_sorted_queries(ab, ae, q.data() + i, q.data() + j, r);
+            else {
+                row.assign(ab, ae);
+                std::sort(row.begin(), row.end());
+                merge_sorted_queries(row.begin(), row.end(), q.data() + i, q.data() + j, r);}
+            i = j;}
+        else {
+            for (; i != j; ++i)
+                r[q[i].second] = edge(s, q[i].first.second, g).second;}}
+
+    for (std::size_t k = 0; k != r.size(); ++k) {
+        *x = (r[k] != 0);
+        ++x;}
+    return x;}
+
+// ---------
+// not_a_dag
+// ---------
+
+/**
+ * thrown by topological_sort when the graph has a cycle
+ */
+class not_a_dag : public std::invalid_argument {
+    public:
+        not_a_dag () :
+            std::invalid_argument("topological_sort: the graph has a cycle")
+            {}};
+
+// -----------
+// SearchState
+// -----------
+
+/**
+ * Working storage for the searches below, indexed by vertex_descriptor.
+ * Passing the same SearchState to many searches reuses its buffers
+ * instead of allocating them again.
+ */
+template <typename G>
+struct SearchState {
+    // --------
+    // typedefs
+    // --------
+
+    typedef typename G::vertex_descriptor  vertex_descriptor;
+    typedef typename G::adjacency_iterator adjacency_iterator;
+    typedef std::pair<vertex_descriptor, std::pair<adjacency_iterator, adjacency_iterator> > frame;
+
+    enum {white, gray, black};
+
+    // ----
+    // data
+    // ----
+
+    std::vector<char>              color; // ! white: unseen, gray: on the stack or queue, black: done
+    std::vector<vertex_descriptor> queue; // ! breadth first frontier
+    std::vector<frame>             stack; // ! depth first path, with the out-edges left to scan
+
+    // -----
+    // reset
+    // -----
+
+    /**
+     * @param n : number of vertices
+     */
+    void reset (std::size_t n) {
+        color.assign(n, white);
+        queue.clear();
+        stack.clear();}};
+
+// ------------
+// NullIterator
+// ------------
+
+/**
+ * output iterator that discards what is written to it
+ */
+struct NullIterator {
+    typedef std::output_iterator_tag iterator_category;
+    typedef void                     value_type;
+    typedef void                     difference_type;
+    typedef void                     pointer;
+    typedef void                     reference;
+
+    NullIterator& operator *  ()         {return *this;}
+    NullIterator& operator ++ ()         {return *this;}
+    NullIterator& operator ++ (int)      {return *this;}
+    template <typename T>
+    NullIterator& operator =  (const T&) {return *this;}};
+
+// -----------------
+// depth_first_visit
+// -----------------
+
+/**
+ * iterative depth first search from r over the white vertices of w.color,
+ * scanning out-edges in adjacency order like boost::depth_first_visit
+ * @param g : input graph
+ * @param r : root, must be white
+ * @param w : search state
+ * @param d : receives each vertex when it is discovered
+ * @param f : receives each vertex when it is finished
+ * @return : true if an edge to a gray vertex (a cycle) was seen
+ */
+template <typename G, typename DI, typename FI>
+bool depth_first_visit (const G& g, typename G::vertex_descriptor r, SearchState<G>& w, DI& d, FI& f) {
+    typedef typename G::vertex_descriptor  vertex_descriptor;
+    typedef typename G::adjacency_iterator adjacency_iterator;
+
+    bool cycle = false;
+    w.color[r] = SearchState<G>::gray;
+    *d = r;
+    ++d;
+    w.stack.push_back(std::make_pair(r, adjacent_vertices(r, g)));
+    while (!w.stack.empty()) {
+        vertex_descriptor  u = w.stack.back().first;
+        adjacency_iterator b = w.stack.back().second.first;
+        adjacency_iterator e = w.stack.back().second.second;
+        w.stack.pop_back();
+        while (b != e) {
+            const vertex_descriptor v = *b;
+            ++b;
+            if (w.color[v] == SearchState<G>::white) {
+                w.stack.push_back(std::make_pair(u, std::make_pair(b, e)));
+                u = v;
+                w.color[u] = SearchState<G>::gray;
+                *d = u;
+                ++d;
+                b = adjacent_vertices(u, g).first;
+                e = adjacent_vertices(u, g).second;}
+            else if (w.color[v] == SearchState<G>::gray)
+                cycle = true;}
+        w.color[u] = SearchState<G>::black;
+        *f = u;
+        ++f;}
+    return cycle;}
+
+// ------------------
+// depth_first_search
+// ------------------
+
+/**
+ * depth first search from every unvisited vertex in vertex order, without recursion
+ * @param g : input graph
+ * @param x : receives the vertices in discovery order
+ * @param w : search state, reused across calls
+ * @return : x advanced past the last vertex
+ */
+template <typename G, typename OI>
+OI depth_first_search (const G& g, OI x, SearchState<G>& w) {
+    NullIterator f;
+    w.reset(num_vertices(g));
+    typename G::vertex_iterator b = vertices(g).first;
+    typename G::vertex_iterator e = vertices(g).second;
+    while (b != e) {
+        if (w.color[*b] == SearchState<G>::white)
+            depth_first_visit(g, *b, w, x, f);
+        ++b;}
+    return x;}
+
+template <typename G, typename OI>
+OI depth_first_search (const G& g, OI x) {
+    SearchState<G> w;
+    return depth_first_search(g, x, w);}
+
+// --------------------
+// breadth_first_search
+// --------------------
+
+/**
+ * breadth first search from s, scanning out-edges in adjacency order like boost::breadth_first_search
+ * @param g : input graph
+ * @param s : source vertex
+ * @param x : receives the reachable vertices in discovery order
+ * @param w : search state, reused across calls
+ * @return : x advanced past the last vertex
+ */
+template <typename G, typename OI>
+OI breadth_first_search (const G& g, typename G::vertex_descriptor s, OI x, SearchState<G>& w) {
+    typedef typename G::adjacency_iterator adjacency_iterator;
+
+    w.reset(num_vertices(g));
+    w.color[s] = SearchState<G>::gray;
+    w.queue.push_back(s);
+    *x = s;
+    ++x;
+    for (std::size_t i = 0; i != w.queue.size(); ++i) {
+        adjacency_iterator b = adjacent_vertices(w.queue[i], g).first;
+        adjacency_iterator e = adjacent_vertices(w.queue[i], g).second;
+        while (b != e) {
+            if (w.color[*b] == SearchState<G>::white) {
+                w.color[*b] = SearchState<G>::gray;
+                w.queue.push_back(*b);
+                *x = *b;
+                ++x;}
+            ++b;}
+        w.color[w.queue[i]] = SearchState<G>::black;}
+    return x;}
+
+template <typename G, typename OI>
+OI breadth_first_search (const G& g, typename G::vertex_descriptor s, OI x) {
+    SearchState<G> w;
+    return breadth_first_search(g, s, x, w);}
+
+// ---------
+// has_cycle
+// ---------
+
+/**
+ * @param g : input graph
+ * @param w : search state, reused across calls
+ * @return : true if g has a directed cycle, self-loops included
+ */
+template <typename G>
+bool has_cycle (const G& g, SearchState<G>& w) {
+    NullIterator d;
+    NullIterator f;
+    w.reset(num_vertices(g));
+    typename G::vertex_iterator b = vertices(g).first;
+    typename G::vertex_iterator e = vertices(g).second;
+    while (b != e) {
+        if ((w.color[*b] == SearchState<G>::white) && depth_first_visit(g, *b, w, d, f))
+            return true;
+        ++b;}
+    return false;}
+
+template <typename G>
+bool has_cycle (const G& g) {
+    SearchState<G> w;
+    return has_cycle(g, w);}
+
+// ----------------
+// topological_sort
+// ----------------
+
+/**
+ * depth first topological sort; like boost::topological_sort, the vertices
+ * come out in reverse topological order (each after everything it reaches)
+ * @param g : input graph
+ * @param x : receives the vertices
+ * @param w : search state, reused across calls
+ * @return : x advanced past the last vertex
+ * @throws not_a_dag : if g has a cycle; x may have received some vertices
+ */
+template <typename G, typename OI>
+OI topological_sort (const G& g, OI x, SearchState<G>& w) {
+    NullIterator d;
+    w.reset(num_vertices(g));
+    typename G::vertex_iterator b = vertices(g).first;
+    typename G::vertex_iterator e = vertices(g).second;
+    while (b != e) {
+        if ((w.color[*b] == SearchState<G>::white) && depth_first_visit(g, *b, w, d, x))
+            throw not_a_dag();
+        ++b;}
+    return x;}
+
+template <typename G, typename OI>
+OI topological_sort (const G& g, OI x) {
+    SearchState<G> w;
+    return topological_sort(g, x, w);}
+
+// ----------
+// WorkerTeam
+// ----------
+
+/**
+ * k threads, the caller among them, that run one round of work after
+ * another: each round splits [0, n) into contiguous slices, and run returns
+ * once every slice is done. The threads are started on the first round
+ * that is big enough to split and are kept until the team is destroyed, so
+ * a level-synchronous algorithm pays for them once per call, not once per
+ * level.
+ */
+class WorkerTeam {
+    private:
+        // ----
+        // data
+        // ----
+
+        unsigned                 _k;       // ! threads, the caller included
+        std::vector<std::thread> _threads; // ! the other k - 1, once started
+        std::mutex               _m;
+        std::condition_variable  _start;   // ! workers wait here for a round
+        std::condition_variable  _done;    // ! the caller waits here for the end of a round
+        std::size_t              _round;   // ! number of rounds started
+        std::size_t              _pending; // ! workers still busy with this round
+        unsigned                 _slices;  // ! slices in this round
+        std::size_t              _n;       // ! items in this round
+        void                   (*_call) (void*, unsigned, std::size_t, std::size_t);
+        void*                    _f;       // ! the callable of this round
+        bool                     _stop;
+
+        // ----
+        // call
+        // ----
+
+        template <typename F>
+        static void call (void* f, unsigned i, std::size_t b, std::size_t e) {
+            (*static_cast<F*>(f))(i, b, e);}
+
+        // ----
+        // work
+        // ----
+
+        /**
+         * loop of worker i: wait for a round, run slice i if there is one
+         */
+        void work (unsigned i) {
+            std::size_t seen = 0;
+            std::unique_lock<std::mutex> lock(_m);
+            for (;;) {
+                while (!_stop && (_round == seen))
+                    _start.wait(lock);
+                if (_stop)
+                    return;
+                seen = _round;
+                if (i >= _slices)
+                    continue;
+                void (*c) (void*, unsigned, std::size_t, std::size_t) = _call;
+                void*             f = _f;
+                const std::size_t n = _n;
+                const unsigned    w = _slices;
+                lock.unlock();
+                c(f, i, n * i / w, n * (i + 1) / w);
+                lock.lock();
+                if (--_pending == 0)
+                    _done.notify_one();}}
+
+    public:
+        // -----------
+        // constructor
+        // -----------
+
+        /**
+         * @param k : number of threads, 0 for hardware_concurrency
+         */
+        explicit WorkerTeam (unsigned k = 0) :
+                _k(k ? k : std::max(1u, std::thread::hardware_concurrency())),
+                _round(0),
+                _pending(0),
+                _slices(0),
+                _n(0),
+                _call(0),
+                _f(0),
+                _stop(false)
+            {}
+
+        WorkerTeam (const WorkerTeam&) = delete;
+        WorkerTeam& operator = (const WorkerTeam&) = delete;
+
+        // ----------
+        // destructor
+        // ----------
+
+        ~WorkerTeam () {
+            {
+            std::lock_guard<std::mutex> lock(_m);
+            _stop = true;
+            }
+            _start.notify_all();
+            for (std::size_t i = 0; i != _threads.size(); ++i)
+                _threads[i].join();}
+
+        // ---
+        // run
+        // ---
+
+        /**
+         * runs f(i, b, e) over slices i of [0, n), at most one per thread
+         * and each of at least grain items; a round too small to split runs
+         * as the single slice f(0, 0, n) on the calling thread
+         * @param n : number of items
+         * @param grain : fewest items worth handing to a thread
+         * @param f : callable taking (unsigned i, std::size_t b, std::size_t e)
+         * @return : number of slices, so f saw i in [0, return)
+         */
+        template <typename F>
+        unsigned run (std::size_t n, std::size_t grain, F& f) {
+            const std::size_t m = n / std::max<std::size_t>(grain, 1);
+            const unsigned    w = static_cast<unsigned>(std::min<std::size_t>(_k, std::max<std::size_t>(m, 1)));
+            if (w == 1) {
+                f(0u, std::size_t(0), n);
+                return 1;}
+            {
+            std::lock_guard<std::mutex> lock(_m);
+            while (_threads.size() + 1 < _k)
+                _threads.push_back(std::thread(&WorkerTeam::work, this, static_cast<unsigned>(_threads.size() + 1)));
+            _call    = &WorkerTeam::call<F>;
+            _f       = &f;
+            _n       = n;
+            _slices  = w;
+            _pending = w - 1;
+            ++_round;
+            }
+            _start.notify_all();
+            f(0u, std::size_t(0), n / w);
+            std::unique_lock<std::mutex> lock(_m);
+            while (_pending != 0)
+                _done.wait(lock);
+            return w;}
+
+        // ----
+        // size
+        // ----
+
+        /**
+         * @return : number of threads, the caller included
+         */
+        unsigned size () const {
+            return _k;}};
+
+// -----------------------------
+// parallel_breadth_first_search
+// -----------------------------
+
+/**
+ * level-synchronous breadth first search on k threads. Each level is
+ * expanded either top-down (frontier vertices claim their unvisited
+ * targets) or bottom-up (unvisited vertices look for a parent in the
+ * frontier among their sources), whichever touches fewer edges; bottom-up
+ * needs the in-edges, so they are gathered once, on the first switch.
+ * The threads are started once per call; a level with fewer than 2 * 1024
+ * vertices to scan is expanded on the calling thread alone, so a deep,
+ * narrow graph costs about what breadth_first_search does.
+ * The result depends only on g and s, never on k or on scheduling.
+ * @param g : input graph
+ * @param s : source vertex
+ * @param k : number of threads, 0 for hardware_concurrency
+ * @return : the distance of every vertex from s, or -1 cast to size_t if unreachable
+ */
+template <typename G>
+std::vector<std::size_t> parallel_breadth_first_search (const G& g, typename G::vertex_descriptor s, unsigned k = 0) {
+    typedef typename G::vertex_descriptor  vertex_descriptor;
+    typedef typename G::adjacency_iterator adjacency_iterator;
+
+    const std::size_t none  = static_cast<std::size_t>(-1);
+    const std::size_t n     = num_vertices(g);
+    const std::size_t alpha = 14; // ! go bottom-up once the frontier's out-edges exceed 1 / alpha of the unexplored edges
+    const std::size_t beta  = 24; // ! go back top-down once the frontier holds fewer than 1 / beta of the vertices
+    const std::size_t grain = 1024;
+
+    std::vector< std::atomic<std::size_t> > d(n);
+    for (std::size_t v = 0; v != n; ++v)
+        d[v].store(none, std::memory_order_relaxed);
+
+    std::vector<std::size_t>       in_offsets; // ! in-edges, built on the first bottom-up step
+    std::vector<vertex_descriptor> in_sources;
+
+    WorkerTeam                                    team(k);
+    std::vector<vertex_descriptor>                frontier(1, s);
+    std::vector< std::vector<vertex_descriptor> > next(team.size());
+    std::size_t unexplored = num_edges(g);
+    bool        bottom_up  = false;
+    d[s].store(0, std::memory_order_relaxed);
+
+    for (std::size_t level = 0; !frontier.empty(); ++level) {
+        std::size_t frontier_edges = 0;
+        for (std::size_t i = 0; i != frontier.size(); ++i)
+            frontier_edges += out_degree(frontier[i], g);
+        unexplored -= std::min(unexplored, frontier_edges);
+        if (!bottom_up && (frontier_edges > unexplored / alpha))
+            bottom_up = true;
+        else if (bottom_up && (frontier.size() < n / beta))
+            bottom_up = false;
+
+        if (bottom_up && in_offsets.empty()) {
+            in_offsets.assign(n + 1, 0);
+            for (std::size_t u = 0; u != n; ++u) {
+                adjacency_iterator b = adjacent_vertices(u, g).first;
+                adjacency_iterator e = adjacent_vertices(u, g).second;
+                for (; b != e; ++b)
+                    ++in_offsets[*b + 1];}
+            for (std::size_t v = 0; v != n; ++v)
+                in_offsets[v + 1] += in_offsets[v];
+            in_sources.resize(in_offsets[n]);
+            std::vector<std::size_t> p(in_offsets.begin(), in_offsets.end() - 1);
+            for (std::size_t u = 0; u != n; ++u) {
+                adjacency_iterator b = adjacent_vertices(u, g).first;
+                adjacency_iterator e = adjacent_vertices(u, g).second;
+                for (; b != e; ++b)
+                    in_sources[p[*b]++] = u;}}
+
+        auto expand = [&] (unsigned i, std::size_t b, std::size_t e) {
+            std::vector<vertex_descriptor>& x = next[i];
+            x.clear();
+            if (bottom_up) {
+                for (std::size_t v = b; v != e; ++v) {
+                    if (d[v].load(std::memory_order_relaxed) != none)
+                        continue;
+                    for (std::size_t j = in_offsets[v]; j != in_offsets[v + 1]; ++j)
+                        if (d[in_sources[j]].load(std::memory_order_relaxed) == level) {
+                            d[v].store(level + 1, std::memory_order_relaxed);
+                            x.push_back(v);
+                            break;}}}
+            else {
+                for (std::size_t j = b; j != e; ++j) {
+                    adjacency_iterator p = adjacent_vertices(frontier[j], g).first;
+                    adjacency_iterator q = adjacent_vertices(frontier[j], g).second;
+                    for (; p != q; ++p) {
+                        std::size_t u = none;
+                        if ((d[*p].load(std::memory_order_relaxed) == none) &&
+                            d[*p].compare_exchange_strong(u, level + 1, std::memory_order_relaxed))
+                            x.push_back(*p);}}}};
+        const unsigned w = team.run(bottom_up ? n : frontier.size(), grain, expand);
+
+        frontier.clear();
+        for (unsigned i = 0; i != w; ++i)
+            frontier.insert(frontier.end(), next[i].begin(), next[i].end());}
+
+    std::vector<std::size_t> r(n);
+    for (std::size_t v = 0; v != n; ++v)
+        r[v] = d[v].load(std::memory_order_relaxed);
+    return r;}
+
+// -------------------------
+// parallel_topological_sort
+// -------------------------
+
+/**
+ * Kahn topological sort on k threads: each round, the threads split the
+ * vertices whose in-degree reached zero and decrement the atomic in-degree
+ * counters of their targets. Unlike topological_sort, the vertices come
+ * out in forward order, one round after another, so the two promise
+ * different orders. Round r holds the vertices whose longest path from a
+ * vertex of in-degree zero has r edges; with deterministic set, each round
+ * is sorted, so the output is the vertices ordered by (r, vertex_descriptor)
+ * whatever k is. The threads are started
+ * once per call; a round of fewer than 2 * 1024 vertices is relaxed on the
+ * calling thread alone, so a deep, narrow DAG costs about what a serial
+ * Kahn sort does.
+ * @param g : input graph
+ * @param x : receives the vertices
+ * @param k : number of threads, 0 for hardware_concurrency
+ * @param deterministic : sort each round by vertex_descriptor, so the output does not depend on k or on scheduling
+ * @return : x advanced past the last vertex
+ * @throws not_a_dag : if g has a cycle; x receives nothing
+ */
+template <typename G, typename OI>
+OI parallel_topological_sort (const G& g, OI x, unsigned k = 0, bool deterministic = true) {
+    typedef typename G::vertex_descriptor  vertex_descriptor;
+    typedef typename G::adjacency_iterator adjacency_iterator;
+
+    const std::size_t n     = num_vertices(g);
+    const std::size_t grain = 1024;
+    WorkerTeam        team(k);
+
+    std::vector< std::atomic<std::size_t> > in(n);
+    for (std::size_t v = 0; v != n; ++v)
+        in[v].store(0, std::memory_order_relaxed);
+    auto count = [&] (unsigned, std::size_t b, std::size_t e) {
+        for (std::size_t u = b; u != e; ++u) {
+            adjacency_iterator p = adjacent_vertices(u, g).first;
+            adjacency_iterator q = adjacent_vertices(u, g).second;
+            for (; p != q; ++p)
+                in[*p].fetch_add(1, std::memory_order_relaxed);}};
+    team.run(n, grain, count);
+
+    std::vector<vertex_descriptor> order;
+    order.reserve(n);
+    for (std::size_t v = 0; v != n; ++v)
+        if (in[v].load(std::memory_order_relaxed) == 0)
+            order.push_back(v);
+
+    std::vector< std::vector<vertex_descriptor> > next(team.size());
+    std::size_t b = 0;
+    while (b != order.size()) {
+        const std::size_t e = order.size();
+        auto relax = [&] (unsigned i, std::size_t from, std::size_t to) {
+            std::vector<vertex_descriptor>& y = next[i];
+            y.clear();
+            for (std::size_t j = b + from; j != b + to; ++j) {
+                adjacency_iterator p = adjacent_vertices(order[j], g).first;
+                adjacency_iterator q = adjacent_vertices(order[j], g).second;
+                for (; p != q; ++p)
+                    if (in[*p].fetch_sub(1, std::memory_order_acq_rel) == 1)
+                        y.push_back(*p);}};
+        const unsigned w = team.run(e - b, grain, relax);
+        for (unsigned i = 0; i != w; ++i)
+            order.insert(order.end(), next[i].begin(), next[i].end());
+        if (deterministic)
+            std::sort(order.begin() + e, order.end());
+        b = e;}
+
+    if (order.size() != n)
+        throw not_a_dag();
+    return std::copy(order.begin(), order.end(), x);}
+
+// --------------
+// bad_graph_file
+// --------------
+
+/**
+ * thrown by save and load_mapped when a graph file cannot be written,
+ * read, or trusted
+ */
+class bad_graph_file : public std::runtime_error {
+    public:
+        explicit bad_graph_file (const std::string& what) :
+            std::runtime_error(what)
+            {}};
+
+// ---------------
+// GraphFileHeader
+// ---------------
+
+/**
+ * First 64 bytes of a graph file, followed by num_vertices + 1 offsets
+ * (std::size_t) and num_edges targets (vertex_descriptor), in the byte
+ * order of the machine that wrote it. The arrays are laid out exactly as
+ * in CompressedGraph, so a mapping of the file can be served in place.
+ */
+struct GraphFileHeader {
+    enum {current_version = 1};
+
+    char          magic[8];        // ! "CSRGRAPH"
+    std::uint32_t version;         // ! current_version
+    std::uint32_t word_sizes;      // ! sizeof(std::size_t) << 8 | sizeof(vertex_descriptor), rejects files from other ABIs
+    std::uint64_t num_vertices;
+    std::uint64_t num_edges;
+    std::uint64_t offsets_sum;     // ! checksum of the offsets
+    std::uint64_t targets_sum;     // ! checksum of the targets
+    std::uint64_t reserved;
+    std::uint64_t header_sum;      // ! checksum of the bytes above
+};
+
+static_assert(sizeof(GraphFileHeader) == 64, "GraphFileHeader must be the 64 bytes the file format describes");
+
+// --------
+// checksum
+// --------
+
+/**
+ * 64-bit FNV-1a, continued from h
+ * @param p : bytes
+ * @param n : number of bytes
+ * @param h : checksum so far
+ * @return : checksum of the bytes so far and p[0, n)
+ */
+inline std::uint64_t checksum (const void* p, std::size_t n, std::uint64_t h = 14695981039346656037ULL) {
+    const unsigned char* b = static_cast<const unsigned char*>(p);
+    for (std::size_t i = 0; i != n; ++i) {
+        h ^= b[i];
+        h *= 1099511628211ULL;}
+    return h;}
+
+// ---------
+// save_file
+// ---------
+
+/**
+ * writes g in the graph file format to path, truncating it in place;
+ * save calls this on a temporary file
+ * @param g : any graph modeling vertices, num_vertices, num_edges, out_degree, and adjacent_vertices
+ * @param path : file to create or truncate
+ * @throws bad_graph_file : if the file cannot be written
+ */
+template <typename G>
+void save_file (const G& g, const std::string& path) {
+    typedef CompressedGraph::vertex_descriptor vertex_descriptor;
+    typedef CompressedGraph::edges_size_type   edges_size_type;
+
+    std::ofstream out(path.c_str(), std::ios::binary | std::ios::trunc);
+    if (!out)
+        throw bad_graph_file("save: cannot open " + path);
+
+    GraphFileHeader h = GraphFileHeader();
+    std::memcpy(h.magic, "CSRGRAPH", 8);
+    h.version      = GraphFileHeader::current_version;
+    h.word_sizes   = (sizeof(edges_size_type) << 8) | sizeof(vertex_descriptor);
+    h.num_vertices = num_vertices(g);
+    h.num_edges    = num_edges(g);
+    h.offsets_sum  = checksum(0, 0);
+    h.targets_sum  = checksum(0, 0);
+    out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+
+    edges_size_type o = 0;
+    typename G::vertex_iterator b = vertices(g).first;
+    typename G::vertex_iterator e = vertices(g).second;
+    out.write(reinterpret_cast<const char*>(&o), sizeof(o));
+    h.offsets_sum = checksum(&o, sizeof(o), h.offsets_sum);
+    for (typename G::vertex_iterator v = b; v != e; ++v) {
+        o += out_degree(*v, g);
+        out.write(reinterpret_cast<const char*>(&o), sizeof(o));
+        h.offsets_sum = checksum(&o, sizeof(o), h.offsets_sum);}
+    if (o != h.num_edges)
+        throw bad_graph_file("save: out-degrees do not add up to num_edges");
+
+    std::vector<vertex_descriptor> row;
+    for (typename G::vertex_iterator v = b; v != e; ++v) {
+        row.assign(adjacent_vertices(*v, g).first, adjacent_vertices(*v, g).second);
+        std::sort(row.begin(), row.end());
+        if (row.empty())
+            continue;
+        out.write(reinterpret_cast<const char*>(row.data()), row.size() * sizeof(vertex_descriptor));
+        h.targets_sum = checksum(row.data(), row.size() * sizeof(vertex_descriptor), h.targets_sum);}
+
+    h.header_sum = checksum(&h, offsetof(GraphFileHeader, header_sum));
+    out.seekp(0);
+    out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+    out.close();
+    if (!out)
+        throw bad_graph_file("save: cannot write " + path);}
+
+// ----
+// save
+// ----
+
+/**
+ * writes g in the graph file format, rows sorted. The file is written to
+ * path + ".tmp.<pid>", synced, and renamed over path, so a process that has
+ * the old file mapped keeps reading the old inode, and a process that opens
+ * path sees either the old file or the whole new one, never a partial one.
+ * @param g : any graph modeling vertices, num_vertices, num_edges, out_degree, and adjacent_vertices
+ * @param path : file to create or replace
+ * @throws bad_graph_file : if the file cannot be written; path is left as it was
+ */
+template <typename G>
+void save (const G& g, const std::string& path) {
+    const std::string tmp = path + ".tmp." + std::to_string(::getpid());
+    try {
+        save_file(g, tmp);
+        const int fd = ::open(tmp.c_str(), O_RDONLY);
+        if ((fd < 0) || (::fsync(fd) != 0)) {
+            if (fd >= 0)
+                ::close(fd);
+            throw bad_graph_file("save: cannot sync " + tmp);}
+        ::close(fd);
+        if (std::rename(tmp.c_str(), path.c_str()) != 0)
+            throw bad_graph_file("save: cannot rename " + tmp + " to " + path);}
+    catch (...) {
+        std::remove(tmp.c_str());
+        throw;}
+
+    // make the rename itself durable; failing that only risks the old file after a crash
+    const std::string::size_type slash = path.rfind('/');
+    const std::string            dir   = (slash == std::string::npos) ? std::string(".") : path.substr(0, slash + 1);
+    const int                    fd    = ::open(dir.c_str(), O_RDONLY);
+    if (fd >= 0) {
+        ::fsync(fd);
+        ::close(fd);}}
+
+// -----------
+// MappedGraph
+// -----------
+
+/**
+ * Read-only graph served straight from a memory mapping of a graph file:
+ * opening it costs one mmap, and pages are read on first touch.
+ * It models the same free-function interface as CompressedGraph.
+ */
+class MappedGraph {
+    public:
+        // --------
+        // typedefs
+        // --------
+
+        typedef CompressedGraph::vertex_descriptor  vertex_descriptor;
+        typedef CompressedGraph::edge_descriptor    edge_descriptor;
+        typedef CompressedGraph::vertices_size_type vertices_size_type;
+        typedef CompressedGraph::edges_size_type    edges_size_type;
+
+        typedef CompressedGraph::vertex_iterator    vertex_iterator;
+        typedef CompressedGraph::edge_iterator      edge_iterator;
+        typedef CompressedGraph::adjacency_iterator adjacency_iterator;
+
+    public:
+        // -----------------
+        // adjacent_vertices
+        // -----------------
+
+        /**
+         * @param v : source vertex
+         * @param g : graph
+         * @return : pair of pointers into the mapping delimiting the sorted targets of v
+         */
+        friend std::pair<adjacency_iterator, adjacency_iterator> adjacent_vertices (vertex_descriptor v, const MappedGraph& g) {
+            return std::make_pair(g._targets + g._offsets[v], g._targets + g._offsets[v + 1]);}
+
+        // ----
+        // edge
+        // ----
+
+        /**
+         * @param s : vertex_descriptor, source
+         * @param t : vertex_descriptor, target
+         * @param g : graph
+         * @return : std::pair<edge_descriptor, bool>, binary search of the row of s
+         */
+        friend std::pair<edge_descriptor, bool> edge (vertex_descriptor s, vertex_descriptor t, const MappedGraph& g) {
+            edge_descriptor e = std::make_pair(s, t);
+            if (s >= g._n)
+                return std::make_pair(e, false);
+            std::pair<adjacency_iterator, adjacency_iterator> p = adjacent_vertices(s, g);
+            return std::make_pair(e, std::binary_search(p.first, p.second, t));}
+
+        // -----
+        // edges
+        // -----
+
+        /**
+         * @param g : input graph
+         * @return : iterators over all edges in (source, target) order
+         */
+        friend std::pair<edge_iterator, edge_iterator> edges (const MappedGraph& g) {
+            edge_iterator b(g._offsets, g._targets, g._n, 0);
+            edge_iterator e(g._offsets, g._targets, g._n, g._offsets[g._n]);
+            return std::make_pair(b, e);}
+
+        // ---------
+        // num_edges
+        // ---------
+
+        /**
+         * @param g : input graph
+         */
+        friend edges_size_type num_edges (const MappedGraph& g) {
+            return g._offsets[g._n];}
+
+        // ------------
+        // num_vertices
+        // ------------
+
+        /**
+         * @param g : input graph
+         */
+        friend vertices_size_type num_vertices (const MappedGraph& g) {
+            return g._n;}
+
+        // ----------
+        // out_degree
+        // ----------
+
+        /**
+         * @param v : source vertex
+         * @param g : input graph
+         * @return : number of edges leaving v
+         */
+        friend edges_size_type out_degree (vertex_descriptor v, const MappedGraph& g) {
+            return g._offsets[v + 1] - g._offsets[v];}
+
+        // ------
+        // source
+        // ------
+
+        /**
+         * @param e : edge
+         * @param g : input graph
+         */
+        friend vertex_descriptor source (edge_descriptor e, const MappedGraph&) {
+            return e.first;}
+
+        // ------
+        // target
+        // ------
+
+        /**
+         * @param e : edge
+         * @param g : input graph
+         */
+        friend vertex_descriptor target (edge_descriptor e, const MappedGraph&) {
+            return e.second;}
+
+        // ------
+        // vertex
+        // ------
+
+        /**
+         * @param idx : vertex_descriptor value
+         * @param g : input graph
+         * @return : vertex_descriptor value
+         */
+        friend vertex_descriptor vertex (vertices_size_type idx, const MappedGraph&) {
+            return idx;}
+
+        // --------
+        // vertices
+        // --------
+
+        /**
+         * @param g : input graph
+         * @return : counting iterators over [0, num_vertices(g))
+         */
+        friend std::pair<vertex_iterator, vertex_iterator> vertices (const MappedGraph& g) {
+            return std::make_pair(vertex_iterator(0), vertex_iterator(g._n));}
+
+    private:
+        // ----
+        // data
+        // ----
+
+        void*                    _base;    // ! the mapping, 0 if none
+        std::size_t              _size;    // ! bytes mapped
+        vertices_size_type       _n;       // ! number of vertices
+        const edges_size_type*   _offsets; // ! into the mapping
+        const vertex_descriptor* _targets; // ! into the mapping
+
+        // -----
+        // unmap
+        // -----
+
+        void unmap () {
+            if (_base)
+                ::munmap(_base, _size);
+            _base = 0;}
+
+    public:
+        // ------------
+        // constructors
+        // ------------
+
+        /**
+         * maps a graph file; the header and the ordering of the offsets are
+         * always checked, which reads the offsets but not the targets;
+         * verify also checksums both arrays and bounds every target
+         * @param path : file written by save
+         * @param verify : also check the targets, which reads every page
+         * @throws bad_graph_file : if the file cannot be mapped, is not a graph file, or fails a check
+         */
+        explicit MappedGraph (const std::string& path, bool verify = true) :
+                _base(0),
+                _size(0),
+                _n(0),
+                _offsets(0),
+                _targets(0) {
+            const int fd = ::open(path.c_str(), O_RDONLY);
+            if (fd < 0)
+                throw bad_graph_file("load_mapped: cannot open " + path);
+            struct stat st;
+            if ((::fstat(fd, &st) != 0) || (static_cast<std::size_t>(st.st_size) < sizeof(GraphFileHeader))) {
+                ::close(fd);
+                throw bad_graph_file("load_mapped: " + path + " is too short for a graph file");}
+            _size = st.st_size;
+            _base = ::mmap(0, _size, PROT_READ, MAP_SHARED, fd, 0);
+            ::close(fd);
+            if (_base == MAP_FAILED) {
+                _base = 0;
+                throw bad_graph_file("load_mapped: cannot map " + path);}
+
+            const GraphFileHeader& h = *static_cast<const GraphFileHeader*>(_base);
+            const char* error = 0;
+            if (std::memcmp(h.magic, "CSRGRAPH", 8) != 0)
+                error = " is not a graph file";
+            else if (h.header_sum != checksum(&h, offsetof(GraphFileHeader, header_sum)))
+                error = " has a corrupt header";
+            else if (h.version != GraphFileHeader::current_version)
+                error = " has an unsupported version";
+            else if (h.word_sizes != ((sizeof(edges_size_type) << 8) | sizeof(vertex_descriptor)))
+                error = " was written with different word sizes";
+            else if ((h.num_vertices >= _size / sizeof(edges_size_type)) || (h.num_edges > _size / sizeof(vertex_descriptor)))
+                error = " has the wrong length";
+            else if (_size != sizeof(h) + (h.num_vertices + 1) * sizeof(edges_size_type) + h.num_edges * sizeof(vertex_descriptor))
+                error = " has the wrong length";
+            if (error) {
+                unmap();
+                throw bad_graph_file("load_mapped: " + path + error);}
+
+            _n       = h.num_vertices;
+            _offsets = reinterpret_cast<const edges_size_type*>(static_cast<const char*>(_base) + sizeof(h));
+            _targets = reinterpret_cast<const vertex_descriptor*>(_offsets + _n + 1);
+            if ((_offsets[0] != 0) || (_offsets[_n] != h.num_edges) || !std::is_sorted(_offsets, _offsets + _n + 1))
+                error = " has inconsistent offsets";
+            else if (verify && (h.offsets_sum != checksum(_offsets, (_n + 1) * sizeof(edges_size_type))))
+                error = " has corrupt offsets";
+            else if (verify && (h.targets_sum != checksum(_targets, h.num_edges * sizeof(vertex_descriptor))))
+                error = " has corrupt targets";
+            else if (verify && (std::find_if(_targets, _targets + h.num_edges, [&] (vertex_descriptor t) {return t >= _n;}) != _targets + h.num_edges))
+                error = " has a target out of range";
+            if (error) {
+                unmap();
+                throw bad_graph_file("load_mapped: " + path + error);}}
+
+        MappedGraph (MappedGraph&& x) :
+                _base(x._base),
+                _size(x._size),
+                _n(x._n),
+                _offsets(x._offsets),
+                _targets(x._targets) {
+            x._base    = 0;
+            x._n       = 0;
+            x._offsets = 0;}
+
+        MappedGraph (const MappedGraph&) = delete;
+        MappedGraph& operator = (const MappedGraph&) = delete;
+
+        // ----------
+        // destructor
+        // ----------
+
+        ~MappedGraph () {
+            unmap();}};
+
+// -----------
+// load_mapped
+// -----------
+
+/**
+ * @param path : file written by save
+ * @param verify : also checksum the offsets and targets, which reads every page
+ * @return : the graph, served from a mapping of the file
+ * @throws bad_graph_file : see MappedGraph
+ */
+inline MappedGraph load_mapped (const std::string& path, bool verify = true) {
+    return MappedGraph(path, verify);}
+
+template <>
+struct sorted_adjacency<MappedGraph> {
+    enum {value = true};};
+
+// ----------
+// BlockGraph
+// ----------
+
+/**
+ * Immutable graph whose rows are stored CSR-style in blocks of block_size
+ * consecutive vertices, each block held by a shared_ptr. Copying a
+ * BlockGraph copies only the block pointers, and a Batch copies just the
+ * blocks it changes, so successive versions of a graph share every block
+ * an update did not touch. It models the same free-function interface as
+ * CompressedGraph.
+ */
+class BlockGraph {
+    public:
+        // --------
+        // typedefs
+        // --------
+
+        typedef CompressedGraph::vertex_descriptor  vertex_descriptor;
+        typedef CompressedGraph::edge_descriptor    edge_descriptor;
+        typedef CompressedGraph::vertices_size_type vertices_size_type;
+        typedef CompressedGraph::edges_size_type    edges_size_type;
+
+        typedef CountingIterator         vertex_iterator;
+        typedef const vertex_descriptor* adjacency_iterator;
+
+        enum {block_size = 256};
+
+        class Batch;
+
+        // -------------
+        // edge_iterator
+        // -------------
+
+        /**
+         * Walks the rows in vertex order, moving from block to block.
+         */
+        class edge_iterator {
+            public:
+                // --------
+                // typedefs
+                // --------
+
+                typedef std::forward_iterator_tag iterator_category;
+                typedef edge_descriptor           value_type;
+                typedef std::ptrdiff_t            difference_type;
+                typedef const edge_descriptor*    pointer;
+                typedef edge_descriptor           reference;
+
+            private:
+                // ----
+                // data
+                // ----
+
+                const BlockGraph*  _g;
+                vertex_descriptor  _s;
+                adjacency_iterator _p; // ! current target in the row of _s, 0 at the end
+                adjacency_iterator _q; // ! end of the row of _s
+
+                // ----
+                // skip
+                // ----
+
+                /**
+                 * moves past empty rows to the next edge, or to the end
+                 */
+                void skip () {
+                    while ((_p == _q) && (_s < _g->_n)) {
+                        if (++_s == _g->_n)
+                            _p = _q = 0;
+                        else
+                            row();}}
+
+                // ---
+                // row
+                // ---
+
+                /**
+                 * points _p and _q at the row of _s
+                 */
+                void row () {
+                    std::pair<adjacency_iterator, adjacency_iterator> p = adjacent_vertices(_s, *_g);
+                    _p = p.first;
+                    _q = p.second;}
+
+            public:
+                // -----------
+                // constructor
+                // -----------
+
+                /**
+                 * @param g : graph
+                 * @param s : first source, num_vertices(g) for the end
+                 */
+                edge_iterator (const BlockGraph* g = 0, vertex_descriptor s = 0) :
+                        _g(g),
+                        _s(s),
+                        _p(0),
+                        _q(0) {
+                    if (_g && (_s < _g->_n)) {
+                        row();
+                        skip();}}
+
+                // ----------
+                // operator *
+                // ----------
+
+                reference operator * () const {
+                    return std::make_pair(_s, *_p);}
+
+                // -----------
+                // operator ++
+                // -----------
+
+                edge_iterator& operator ++ () {
+                    ++_p;
+                    skip();
+                    return *this;}
+
+                edge_iterator operator ++ (int) {
+                    edge_iterator x = *this;
+                    ++*this;
+                    return x;}
+
+                // -----------
+                // operator ==
+                // -----------
+
+                friend bool operator == (const edge_iterator& lhs, const edge_iterator& rhs) {
+                    return (lhs._s == rhs._s) && (lhs._p == rhs._p);}
+
+                // -----------
+                // operator !=
+                // -----------
+
+                friend bool operator != (const edge_iterator& lhs, const edge_iterator& rhs) {
+                    return !(lhs == rhs);}};
+
+    private:
+        // -----
+        // Block
+        // -----
+
+        struct Block {
+            std::vector<edges_size_type>   offsets; // ! row starts, one more entry than rows
+            std::vector<vertex_descriptor> targets; // ! row contents, sorted per vertex
+
+            Block () :
+                offsets(1, 0)
+                {}};
+
+        // ----
+        // data
+        // ----
+
+        std::vector< std::shared_ptr<Block> > _blocks; // ! never changed once shared; see Batch
+        vertices_size_type                    _n;
+        edges_size_type                       _m;
+
+    public:
+        // -----------------
+        // adjacent_vertices
+        // -----------------
+
+        /**
+         * @param v : source vertex
+         * @param g : graph
+         * @return : pair of pointers delimiting the sorted targets of v
+         */
+        friend std::pair<adjacency_iterator, adjacency_iterator> adjacent_vertices (vertex_descriptor v, const BlockGraph& g) {
+            const Block&      k = *g._blocks[v / block_size];
+            const std::size_t r = v % block_size;
+            return std::make_pair(k.targets.data() + k.offsets[r], k.targets.data() + k.offsets[r + 1]);}
+
+        // ----
+        // edge
+        // ----
+
+        /**
+         * @param s : vertex_descriptor, source
+         * @param t : vertex_descriptor, target
+         * @param g : graph
+         * @return : std::pair<edge_descriptor, bool>, binary search of the row of s
+         */
+        friend std::pair<edge_descriptor, bool> edge (vertex_descriptor s, vertex_descriptor t, const BlockGraph& g) {
+            edge_descriptor e = std::make_pair(s, t);
+            if (s >= g._n)
+                return std::make_pair(e, false);
+            std::pair<adjacency_iterator, adjacency_iterator> p = adjacent_vertices(s, g);
+            return std::make_pair(e, std::binary_search(p.first, p.second, t));}
+
+        // -----
+        // edges
+        // -----
+
+        /**
+         * @param g : input graph
+         * @return : iterators over all edges in (source, target) order
+         */
+        friend std::pair<edge_iterator, edge_iterator> edges (const BlockGraph& g) {
+            return std::make_pair(edge_iterator(&g, 0), edge_iterator(&g, g._n));}
+
+        // ---------
+        // num_edges
+        // ---------
+
+        /**
+         * @param g : input graph
+         */
+        friend edges_size_type num_edges (const BlockGraph& g) {
+            return g._m;}
+
+        // ------------
+        // num_vertices
+        // ------------
+
+        /**
+         * @param g : input graph
+         */
+        friend vertices_size_type num_vertices (const BlockGraph& g) {
+            return g._n;}
+
+        // ----------
+        // out_degree
+        // ----------
+
+        /**
+         * @param v : source vertex
+         * @param g : input graph
+         * @return : number of edges leaving v
+         */
+        friend edges_size_type out_degree (vertex_descriptor v, const BlockGraph& g) {
+            const Block&      k = *g._blocks[v / block_size];
+            const std::size_t r = v % block_size;
+            return k.offsets[r + 1] - k.offsets[r];}
+
+        // ------
+        // source
+        // ------
+
+        /**
+         * @param e : edge
+         * @param g : input graph
+         */
+        friend vertex_descriptor source (edge_descriptor e, const BlockGraph&) {
+            return e.first;}
+
+        // ------
+        // target
+        // ------
+
+        /**
+         * @param e : edge
+         * @param g : input graph
+         */
+        friend vertex_descriptor target (edge_descriptor e, const BlockGraph&) {
+            return e.second;}
+
+        // ------
+        // vertex
+        // ------
+
+        /**
+         * @param idx : vertex_descriptor value
+         * @param g : input graph
+         * @return : vertex_descriptor value
+         */
+        friend vertex_descriptor vertex (vertices_size_type idx, const BlockGraph&) {
+            return idx;}
+
+        // --------
+        // vertices
+        // --------
+
+        /**
+         * @param g : input graph
+         * @return : counting iterators over [0, num_vertices(g))
+         */
+        friend std::pair<vertex_iterator, vertex_iterator> vertices (const BlockGraph& g) {
+            return std::make_pair(vertex_iterator(0), vertex_iterator(g._n));}
+
+        // ------------
+        // constructors
+        // ------------
+
+        /**
+         * empty graph
+         */
+        BlockGraph () :
+            _n(0),
+            _m(0)
+            {}
+
+        /**
+         * @param g : any graph modeling vertices, num_vertices, and adjacent_vertices
+         */
+        template <typename G>
+        explicit BlockGraph (const G& g) :
+                _n(0),
+                _m(0) {
+            _blocks.reserve((num_vertices(g) + block_size - 1) / block_size);
+            typename G::vertex_iterator b = vertices(g).first;
+            typename G::vertex_iterator e = vertices(g).second;
+            for (; b != e; ++b, ++_n) {
+                if (_n % block_size == 0)
+                    _blocks.push_back(std::make_shared<Block>());
+                Block& k = *_blocks.back();
+                typename G::adjacency_iterator ab = adjacent_vertices(*b, g).first;
+                typename G::adjacency_iterator ae = adjacent_vertices(*b, g).second;
+                k.targets.insert(k.targets.end(), ab, ae);
+                std::sort(k.targets.begin() + k.offsets.back(), k.targets.end());
+                _m += k.targets.size() - k.offsets.back();
+                k.offsets.push_back(k.targets.size());}}
+
+        // Default copy, destructor, and copy assignment; a copy shares every block
+        // BlockGraph  (const BlockGraph&);
+        // ~BlockGraph ();
+        // BlockGraph& operator = (const BlockGraph&);
+    };
+
+// -----------------
+// BlockGraph::Batch
+// -----------------
+
+/**
+ * A set of changes to a BlockGraph, made through the same free functions
+ * as Graph's. The first change to a block copies it, O(block_size plus its
+ * edges), and later changes to it are made in place, so a batch costs
+ * O(num_vertices / block_size) for the block table plus the blocks it
+ * touches. clear_vertex reads every row to find the in-edges of v but
+ * copies only the blocks that hold one; remove_vertex renumbers every
+ * vertex after v, so it rewrites every block.
+ */
+class BlockGraph::Batch {
+    public:
+        // --------
+        // typedefs
+        // --------
+
+        typedef BlockGraph::vertex_descriptor  vertex_descriptor;
+        typedef BlockGraph::edge_descriptor    edge_descriptor;
+        typedef BlockGraph::vertices_size_type vertices_size_type;
+        typedef BlockGraph::edges_size_type    edges_size_type;
+
+        typedef BlockGraph::vertex_iterator    vertex_iterator;
+        typedef BlockGraph::adjacency_iterator adjacency_iterator;
+
+    private:
+        // ----
+        // data
+        // ----
+
+        BlockGraph        _g;
+        std::vector<bool> _mine; // ! block i was copied by this batch, so it can be changed in place
+
+        // ---
+        // own
+        // ---
+
+        /**
+         * @param v : vertex_descriptor
+         * @return : the block of v, copied first if it may be shared
+         */
+        Block& own (vertex_descriptor v) {
+            const std::size_t i = v / block_size;
+            if (!_mine[i]) {
+                _g._blocks[i] = std::make_shared<Block>(*_g._blocks[i]);
+                _mine[i] = true;}
+            return *_g._blocks[i];}
+
+        // ----
+        // grow
+        // ----
+
+        /**
+         * @return : a new vertex with no edges
+         */
+        vertex_descriptor grow () {
+            if (_g._n % block_size == 0) {
+                _g._blocks.push_back(std::make_shared<Block>());
+                _mine.push_back(true);}
+            Block& k = own(_g._n);
+            k.offsets.push_back(k.offsets.back());
+            return _g._n++;}
+
+        // ------
+        // insert
+        // ------
+
+        /**
+         * @return : true if (s, t) was not there and now is
+         */
+        bool insert (vertex_descriptor s, vertex_descriptor t) {
+            while (_g._n <= std::max(s, t))
+                grow();
+            std::pair<adjacency_iterator, adjacency_iterator> p = adjacent_vertices(s, _g);
+            adjacency_iterator i = std::lower_bound(p.first, p.second, t);
+            if ((i != p.second) && (*i == t))
+                return false;
+            const std::size_t j = i - _g._blocks[s / block_size]->targets.data();
+            Block& k = own(s);
+            k.targets.insert(k.targets.begin() + j, t);
+            for (std::size_t r = s % block_size + 1; r != k.offsets.size(); ++r)
+                ++k.offsets[r];
+            ++_g._m;
+            return true;}
+
+        // -----
+        // erase
+        // -----
+
+        /**
+         * removes the targets [b, e) of the row of s
+         * @param b : position in the row of s
+         * @param e : position in the row of s
+         */
+        void erase (vertex_descriptor s, adjacency_iterator b, adjacency_iterator e) {
+            if (b == e)
+                return;
+            const std::size_t i = b - _g._blocks[s / block_size]->targets.data();
+            const std::size_t d = e - b;
+            Block& k = own(s);
+            k.targets.erase(k.targets.begin() + i, k.targets.begin() + i + d);
+            for (std::size_t r = s % block_size + 1; r != k.offsets.size(); ++r)
+                k.offsets[r] -= d;
+            _g._m -= d;}
+
+        // --------
+        // renumber
+        // --------
+
+        /**
+         * rebuilds every block without the row of v, moving the vertices
+         * after v, and the targets naming them, one lower; v has no edges
+         */
+        void renumber (vertex_descriptor v) {
+            std::vector< std::shared_ptr<Block> > x;
+            x.reserve(_g._blocks.size());
+            for (vertex_descriptor u = 0; u != _g._n; ++u) {
+                if (u == v)
+                    continue;
+                if ((u - (u > v)) % block_size == 0)
+                    x.push_back(std::make_shared<Block>());
+                Block& k = *x.back();
+                std::pair<adjacency_iterator, adjacency_iterator> p = adjacent_vertices(u, _g);
+                for (; p.first != p.second; ++p.first)
+                    k.targets.push_back(*p.first - (*p.first > v));
+                k.offsets.push_back(k.targets.size());}
+            _g._blocks.swap(x);
+            _g._n -= 1;
+            _mine.assign(_g._blocks.size(), true);}
+
+    public:
+        // --------
+        // add_edge
+        // --------
+
+        /**
+         * adds any missing vertices up to s and t, like Graph's add_edge
+         * @param s : vertex_descriptor, source
+         * @param t : vertex_descriptor, target
+         * @param b : batch
+         * @return : pair<edge_descriptor, bool>, false if the edge was already there
+         */
+        friend std::pair<edge_descriptor, bool> add_edge (vertex_descriptor s, vertex_descriptor t, Batch& b) {
+            return std::make_pair(std::make_pair(s, t), b.insert(s, t));}
+
+        // ----------
+        // add_vertex
+        // ----------
+
+        /**
+         * @param b : batch
+         * @return : the new vertex
+         */
+        friend vertex_descriptor add_vertex (Batch& b) {
+            return b.grow();}
+
+        // -----------
+        // remove_edge
+        // -----------
+
+        /**
+         * removes (s, t) if it is there; copies nothing if it is not
+         * @param s : vertex_descriptor, source
+         * @param t : vertex_descriptor, target
+         * @param b : batch
+         */
+        friend void remove_edge (vertex_descriptor s, vertex_descriptor t, Batch& b) {
+            if (s >= num_vertices(b._g))
+                return;
+            std::pair<adjacency_iterator, adjacency_iterator> p = adjacent_vertices(s, b._g);
+            adjacency_iterator i = std::lower_bound(p.first, p.second, t);
+            if ((i != p.second) && (*i == t))
+                b.erase(s, i, i + 1);}
+
+        /**
+         * @param e : edge
+         * @param b : batch
+         */
+        friend void remove_edge (edge_descriptor e, Batch& b) {
+            remove_edge(e.first, e.second, b);}
+
+        // ------------
+        // clear_vertex
+        // ------------
+
+        /**
+         * removes every edge into or out of v
+         * @param v : vertex_descriptor
+         * @param b : batch
+         */
+        friend void clear_vertex (vertex_descriptor v, Batch& b) {
+            std::pair<adjacency_iterator, adjacency_iterator> p = adjacent_vertices(v, b._g);
+            b.erase(v, p.first, p.second);
+            for (vertex_descriptor u = 0; u != num_vertices(b._g); ++u)
+                remove_edge(u, v, b);}
+
+        // -------------
+        // remove_vertex
+        // -------------
+
+        /**
+         * removes v and its edges; every vertex after v is renumbered one
+         * lower, as in Graph, which rewrites every block
+         * @param v : vertex_descriptor
+         * @param b : batch
+         */
+        friend void remove_vertex (vertex_descriptor v, Batch& b) {
+            clear_vertex(v, b);
+            b.renumber(v);}
+
+        // -----------------
+        // adjacent_vertices
+        // -----------------
+
+        /**
+         * @param v : source vertex
+         * @param b : batch
+         * @return : the sorted targets of v; invalidated by the next change to the batch
+         */
+        friend std::pair<adjacency_iterator, adjacency_iterator> adjacent_vertices (vertex_descriptor v, const Batch& b) {
+            return adjacent_vertices(v, b._g);}
+
+        // ----
+        // edge
+        // ----
+
+        /**
+         * @param s : vertex_descriptor, source
+         * @param t : vertex_descriptor, target
+         * @param b : batch
+         */
+        friend std::pair<edge_descriptor, bool> edge (vertex_descriptor s, vertex_descriptor t, const Batch& b) {
+            return edge(s, t, b._g);}
+
+        // ---------
+        // num_edges
+        // ---------
+
+        /**
+         * @param b : batch
+         */
+        friend edges_size_type num_edges (const Batch& b) {
+            return num_edges(b._g);}
+
+        // ------------
+        // num_vertices
+        // ------------
+
+        /**
+         * @param b : batch
+         */
+        friend vertices_size_type num_vertices (const Batch& b) {
+            return num_vertices(b._g);}
+
+        // ----------
+        // out_degree
+        // ----------
+
+        /**
+         * @param v : source vertex
+         * @param b : batch
+         */
+        friend edges_size_type out_degree (vertex_descriptor v, const Batch& b) {
+            return out_degree(v, b._g);}
+
+        // --------
+        // vertices
+        // --------
+
+        /**
+         * @param b : batch
+         */
+        friend std::pair<vertex_iterator, vertex_iterator> vertices (const Batch& b) {
+            return vertices(b._g);}
+
+        // -----------
+        // constructor
+        // -----------
+
+        /**
+         * @param g : graph to change; it is not modified, and its blocks stay shared until changed
+         */
+        explicit Batch (const BlockGraph& g) :
+            _g(g),
+            _mine(g._blocks.size(), false)
+            {}
+
+        Batch (const Batch&) = delete;
+        Batch& operator = (const Batch&) = delete;
+
+        // -------
+        // release
+        // -------
+
+        /**
+         * @return : the changed graph; the batch is left empty
+         */
+        BlockGraph release () {
+            BlockGraph g;
+            std::swap(g._blocks, _g._blocks);
+            std::swap(g._n, _g._n);
+            std::swap(g._m, _g._m);
+            _mine.clear();
+            return g;}};
+
+template <>
+struct sorted_adjacency<BlockGraph> {
+    enum {value = true};};
+
+// ---------------
+// ConcurrentGraph
+// ---------------
+
+/**
+ * A graph for many readers and one writer. Readers traverse an immutable
+ * BlockGraph snapshot that stays valid for as long as they hold a Reader;
+ * the writer applies a Batch to the current snapshot and publishes the
+ * result as the next one, so readers never see a half-applied update and
+ * never take a lock. Consecutive snapshots share every block of rows the
+ * update did not touch, so an update costs O(num_vertices / block_size)
+ * plus the blocks it changes, and the memory held is one graph plus the
+ * changed blocks of the snapshots Readers still pin.
+ * Old snapshots are reclaimed by epochs: each Reader marks a slot with the
+ * epoch it started in, and a snapshot retired in epoch R is deleted once
+ * no slot holds an epoch at or below R; blocks it shares with newer
+ * snapshots live on in them.
+ */
+class ConcurrentGraph {
+    public:
+        // --------
+        // typedefs
+        // --------
+
+        typedef BlockGraph::vertex_descriptor  vertex_descriptor;
+        typedef BlockGraph::edge_descriptor    edge_descriptor;
+        typedef BlockGraph::vertices_size_type vertices_size_type;
+        typedef BlockGraph::edges_size_type    edges_size_type;
+
+        typedef BlockGraph::Batch Batch;
+
+    private:
+        // --------
+        // Snapshot
+        // --------
+
+        struct Snapshot {
+            BlockGraph         graph;
+            unsigned long long version;
+
+            Snapshot (BlockGraph&& g, unsigned long long v) :
+                graph(std::move(g)),
+                version(v)
+                {}};
+
+        // ----
+        // data
+        // ----
+
+        std::atomic<const Snapshot*>                   _current; // ! what new readers see
+        std::atomic<unsigned long long>                _epoch;   // ! starts at 1
+        std::vector< std::atomic<unsigned long long> > _slots;   // ! epoch of each active Reader, 0 if free
+        std::vector< std::pair<const Snapshot*, unsigned long long> > _retired; // ! replaced snapshots and the epoch they were replaced in
+        std::mutex                                     _writer;  // ! serializes writers; never taken by readers
+
+        // -------
+        // reclaim
+        // -------
+
+        /**
+         * deletes the retired snapshots no Reader can still hold; call with _writer held
+         */
+        void reclaim () {
+            unsigned long long oldest = static_cast<unsigned long long>(-1);
+            for (std::size_t i = 0; i != _slots.size(); ++i) {
+                const unsigned long long e = _slots[i].load();
+                if ((e != 0) && (e < oldest))
+                    oldest = e;}
+            std::size_t j = 0;
+            for (std::size_t i = 0; i != _retired.size(); ++i)
+                if (_retired[i].second < oldest)
+                    delete _retired[i].first;
+                else
+                    _retired[j++] = _retired[i];
+            _retired.resize(j);}
+
+    public:
+        // ------
+        // Reader
+        // ------
+
+        /**
+         * Pins the current snapshot for as long as it lives. Taking one
+         * claims a free slot with a compare-and-swap and then loads the
+         * snapshot pointer; if every slot is taken it spins until one frees.
+         */
+        class Reader {
+            private:
+                // ----
+                // data
+                // ----
+
+                ConcurrentGraph& _c;
+                std::size_t      _slot;
+                const Snapshot*  _s;
+
+            public:
+                // -----------
+                // constructor
+                // -----------
+
+                /**
+                 * @param c : the graph to read
+                 */
+                explicit Reader (ConcurrentGraph& c) :
+                        _c(c),
+                        _slot(std::hash<std::thread::id>()(std::this_thread::get_id()) % c._slots.size()),
+                        _s(0) {
+                    for (;;) {
+                        unsigned long long z = 0;
+                        if (_c._slots[_slot].compare_exchange_strong(z, _c._epoch.load()))
+                            break;
+                        if (++_slot == _c._slots.size()) {
+                            _slot = 0;
+                            std::this_thread::yield();}}
+                    _s = _c._current.load();}
+
+                Reader (const Reader&) = delete;
+                Reader& operator = (const Reader&) = delete;
+
+                // ----------
+                // destructor
+                // ----------
+
+                ~Reader () {
+                    _c._slots[_slot].store(0);}
+
+                // -----
+                // graph
+                // -----
+
+                /**
+                 * @return : the pinned snapshot, unchanged for the life of this Reader
+                 */
+                const BlockGraph& graph () const {
+                    return _s->graph;}
+
+                // -------
+                // version
+                // -------
+
+                /**
+                 * @return : number of updates published before the pinned snapshot
+                 */
+                unsigned long long version () const {
+                    return _s->version;}};
+
+        // ------------
+        // constructors
+        // ------------
+
+        /**
+         * @param g : initial graph
+         * @param readers : maximum number of Readers alive at once
+         * @throws invalid_argument : if readers is 0
+         */
+        explicit ConcurrentGraph (const Graph& g = Graph(), std::size_t readers = 64) :
+                _current(0),
+                _epoch(1),
+                _slots(readers) {
+            if (readers == 0)
+                throw std::invalid_argument("ConcurrentGraph: readers must be at least 1");
+            for (std::size_t i = 0; i != _slots.size(); ++i)
+                _slots[i].store(0);
+            _current.store(new Snapshot(BlockGraph(g), 0));}
+
+        ConcurrentGraph (const ConcurrentGraph&) = delete;
+        ConcurrentGraph& operator = (const ConcurrentGraph&) = delete;
+
+        // ----------
+        // destructor
+        // ----------
+
+        /**
+         * no Reader may outlive the graph
+         */
+        ~ConcurrentGraph () {
+            for (std::size_t i = 0; i != _retired.size(); ++i)
+                delete _retired[i].first;
+            delete _current.load();}
+
+        // ------
+        // update
+        // ------
+
+        /**
+         * applies f to a Batch over the current snapshot and publishes the
+         * result as one snapshot; if f throws, nothing is published
+         * @param f : callable taking Batch&, e.g. calling add_edge, remove_edge, clear_vertex, remove_vertex
+         * @return : the version of the new snapshot
+         */
+        template <typename F>
+        unsigned long long update (F f) {
+            std::lock_guard<std::mutex> lock(_writer);
+            const Snapshot* s = _current.load();
+            Batch           b(s->graph);
+            f(b);
+            const unsigned long long v = s->version + 1;
+            _current.store(new Snapshot(b.release(), v));
+            _retired.push_back(std::make_pair(s, _epoch.fetch_add(1)));
+            reclaim();
+            return v;}
+
+        // -------
+        // retired
+        // -------
+
+        /**
+         * @return : number of replaced snapshots still waiting for Readers to finish
+         */
+        std::size_t retired () {
+            std::lock_guard<std::mutex> lock(_writer);
+            reclaim();
+            return _retired.size();}};
+
 #endif // Graph_h